@@ -0,0 +1,371 @@
+#include "oxanalyticlight.h"
+#include <math.h>
+#include <algorithm>
+
+namespace OX {
+	namespace {
+		const double pi_g = 3.14159265358979323846;
+
+		// sa(n x n)̋ts𕔕s{bgItGauss-Jordan@ŋ߂
+		//  ߂l : قȏꍇfalse
+		bool invertMatrix( std::vector< double > a, uint32_t n, double *inv ) {
+			for ( uint32_t i = 0; i < n * n; ++i )
+				inv[ i ] = ( i / n == i % n ? 1.0 : 0.0 );
+			for ( uint32_t c = 0; c < n; ++c ) {
+				uint32_t pivot = c;
+				for ( uint32_t r = c + 1; r < n; ++r ) {
+					if ( fabs( a[ r * n + c ] ) > fabs( a[ pivot * n + c ] ) )
+						pivot = r;
+				}
+				if ( fabs( a[ pivot * n + c ] ) < 1.0e-12 )
+					return false;
+				if ( pivot != c ) {
+					for ( uint32_t k = 0; k < n; ++k ) {
+						std::swap( a[ c * n + k ], a[ pivot * n + k ] );
+						std::swap( inv[ c * n + k ], inv[ pivot * n + k ] );
+					}
+				}
+				double d = 1.0 / a[ c * n + c ];
+				for ( uint32_t k = 0; k < n; ++k ) {
+					a[ c * n + k ] *= d;
+					inv[ c * n + k ] *= d;
+				}
+				for ( uint32_t r = 0; r < n; ++r ) {
+					if ( r == c )
+						continue;
+					double f = a[ r * n + c ];
+					if ( f == 0.0 )
+						continue;
+					for ( uint32_t k = 0; k < n; ++k ) {
+						a[ r * n + k ] -= f * a[ c * n + k ];
+						inv[ r * n + k ] -= f * inv[ c * n + k ];
+					}
+				}
+			}
+			return true;
+		}
+
+		void normalize( double *v ) {
+			double l = sqrt( v[ 0 ] * v[ 0 ] + v[ 1 ] * v[ 1 ] + v[ 2 ] * v[ 2 ] );
+			v[ 0 ] /= l;
+			v[ 1 ] /= l;
+			v[ 2 ] /= l;
+		}
+
+		double dot( const double *a, const double *b ) {
+			return a[ 0 ] * b[ 0 ] + a[ 1 ] * b[ 1 ] + a[ 2 ] * b[ 2 ];
+		}
+
+		void cross( const double *a, const double *b, double *out ) {
+			out[ 0 ] = a[ 1 ] * b[ 2 ] - a[ 2 ] * b[ 1 ];
+			out[ 1 ] = a[ 2 ] * b[ 0 ] - a[ 0 ] * b[ 2 ];
+			out[ 2 ] = a[ 0 ] * b[ 1 ] - a[ 1 ] * b[ 0 ];
+		}
+	}
+
+	namespace SphericalHarmonics {
+
+		// s쐬
+		AnalyticLight AnalyticLight::directional( double x, double y, double z, double r, double g, double b ) {
+			AnalyticLight light;
+			light.type_ = Type_Directional;
+			light.x_ = x;
+			light.y_ = y;
+			light.z_ = z;
+			light.r_ = r;
+			light.g_ = g;
+			light.b_ = b;
+			return light;
+		}
+
+		// _쐬
+		AnalyticLight AnalyticLight::point( double x, double y, double z, double r, double g, double b ) {
+			AnalyticLight light = directional( x, y, z, r, g, b );
+			light.type_ = Type_Point;
+			return light;
+		}
+
+		// 쐬
+		AnalyticLight AnalyticLight::sphere( double x, double y, double z, double radius, double r, double g, double b ) {
+			AnalyticLight light = directional( x, y, z, r, g, b );
+			light.type_ = Type_Sphere;
+			light.radius_ = radius;
+			return light;
+		}
+
+		// p`ʌ쐬
+		AnalyticLight AnalyticLight::polygon( const std::vector< double > &vertices, double r, double g, double b ) {
+			AnalyticLight light = directional( 0.0, 1.0, 0.0, r, g, b );
+			light.type_ = Type_Polygon;
+			light.vertices_ = vertices;
+			return light;
+		}
+
+
+
+		// 
+		Error LightEstimater::estimate( const std::vector< AnalyticLight > &lights, Result &res ) {
+			return estimate( lights.data(), lights.size(), res );
+		}
+
+		// 
+		Error LightEstimater::estimate( const AnalyticLight *lights, size_t lightNum, Result &res ) {
+			if ( lights == 0 && lightNum > 0 )
+				return Error( "Null object" );
+
+			const uint32_t fnum = ( maxLevel_ + 1 ) * ( maxLevel_ + 1 );
+			std::vector< double > coefs( fnum * 3, 0.0 );	// RGB̃v[izu
+			std::vector< double > yvals( fnum );
+			std::vector< double > bandScales( maxLevel_ + 1 );
+			std::vector< double > funcScales( fnum );
+			std::vector< double > legendre( maxLevel_ + 2 );
+
+			for ( size_t i = 0; i < lightNum; ++i ) {
+				const AnalyticLight &light = lights[ i ];
+				if ( light.type_ == AnalyticLight::Type_Polygon ) {
+					Error err = projectPolygon( light, coefs.data(), fnum );
+					if ( err.error_ )
+						return err;
+					continue;
+				}
+
+				double dir[ 3 ] = { light.x_, light.y_, light.z_ };
+				double dist = sqrt( dot( dir, dir ) );
+				if ( dist <= 0.0 && !( light.type_ == AnalyticLight::Type_Sphere && light.radius_ > 0.0 ) )
+					return Error( "invalid light direction or position." );
+				if ( dist > 0.0 )
+					normalize( dir );
+				else
+					dir[ 0 ] = 0.0, dir[ 1 ] = 1.0, dir[ 2 ] = 0.0;
+
+				// banďW
+				if ( light.type_ == AnalyticLight::Type_Sphere ) {
+					//  cosȏ̑ыa֐: 2΁_{cos}^{1} P_l(t) dt
+					double t = ( light.radius_ >= dist ? -1.0 : sqrt( 1.0 - ( light.radius_ / dist ) * ( light.radius_ / dist ) ) );
+					legendre[ 0 ] = 1.0;
+					legendre[ 1 ] = t;
+					for ( uint32_t l = 1; l <= maxLevel_; ++l )
+						legendre[ l + 1 ] = ( ( 2.0 * l + 1 ) * t * legendre[ l ] - l * legendre[ l - 1 ] ) / ( l + 1 );
+					bandScales[ 0 ] = 2.0 * pi_g * ( 1.0 - t );
+					for ( uint32_t l = 1; l <= maxLevel_; ++l )
+						bandScales[ l ] = 2.0 * pi_g * ( legendre[ l - 1 ] - legendre[ l + 1 ] ) / ( 2.0 * l + 1 );
+				} else {
+					double s = ( light.type_ == AnalyticLight::Type_Point ? 1.0 / ( dist * dist ) : 1.0 );
+					for ( uint32_t l = 0; l <= maxLevel_; ++l )
+						bandScales[ l ] = s;
+				}
+				for ( uint32_t l = 0; l <= maxLevel_; ++l ) {
+					for ( uint32_t f = l * l; f < ( l + 1 ) * ( l + 1 ); ++f )
+						funcScales[ f ] = bandScales[ l ];
+				}
+
+				// Y_lmŉ]Z
+				evalSphericalHarmonics( maxLevel_, dir[ 0 ], dir[ 1 ], dir[ 2 ], yvals.data() );
+				double *coefsR = &coefs[ 0 ];
+				double *coefsG = &coefs[ fnum ];
+				double *coefsB = &coefs[ fnum * 2 ];
+				const double r = light.r_, g = light.g_, b = light.b_;
+				for ( uint32_t f = 0; f < fnum; ++f ) {
+					double v = funcScales[ f ] * yvals[ f ];
+					coefsR[ f ] += r * v;
+					coefsG[ f ] += g * v;
+					coefsB[ f ] += b * v;
+				}
+			}
+
+			res.set( maxLevel_, &coefs[ 0 ], &coefs[ fnum ], &coefs[ fnum * 2 ], 1.0 );
+			return Error();
+		}
+
+		// p`p̌W
+		//  band lɂ2l+1̕w_kA@藝
+		//   P_l(w_kE) = 4/(2l+1) _m Y_lm(w_k) Y_lm()
+		//  ђa[u̐ϕY_lm̌Wɕϊs
+		void LightEstimater::prepareZonalLobes() {
+			if ( lobeLevel_ == maxLevel_ )
+				return;
+			const uint32_t fnum = ( maxLevel_ + 1 ) * ( maxLevel_ + 1 );
+			std::vector< double > yvals( fnum );
+
+			lobeDirs_.assign( fnum * 3, 0.0 );
+			lobeInvs_.clear();
+			for ( uint32_t l = 0; l <= maxLevel_; ++l ) {
+				const uint32_t n = 2 * l + 1;
+				double *dirs = &lobeDirs_[ l * l * 3 ];
+				std::vector< double > mat( n * n );
+				std::vector< double > inv( n * n );
+				// ^̗̕ǂ̂I
+				//  Ώ̂ȓ_͊bandœقɂȂ邽ߎgȂ
+				std::vector< double > trialDirs( n * 3 );
+				double bestMaxInv = -1.0;
+				uint32_t seed = 12345 + l;
+				for ( uint32_t trial = 0; trial < 32; ++trial ) {
+					for ( uint32_t k = 0; k < n; ++k ) {
+						seed = seed * 1664525u + 1013904223u;
+						double y = 1.0 - 2.0 * ( seed >> 8 ) / 16777216.0;
+						seed = seed * 1664525u + 1013904223u;
+						double phi = 2.0 * pi_g * ( seed >> 8 ) / 16777216.0;
+						double r = sqrt( 1.0 - y * y );
+						trialDirs[ k * 3 + 0 ] = r * cos( phi );
+						trialDirs[ k * 3 + 1 ] = y;
+						trialDirs[ k * 3 + 2 ] = r * sin( phi );
+						evalSphericalHarmonics( l, trialDirs[ k * 3 + 0 ], trialDirs[ k * 3 + 1 ], trialDirs[ k * 3 + 2 ], yvals.data() );
+						for ( uint32_t m = 0; m < n; ++m )
+							mat[ k * n + m ] = yvals[ l * l + m ];
+					}
+					std::vector< double > trialInv( n * n );
+					if ( invertMatrix( mat, n, trialInv.data() ) == false )
+						continue;
+					double maxInv = 0.0;
+					for ( auto v : trialInv )
+						maxInv = ( fabs( v ) > maxInv ? fabs( v ) : maxInv );
+					if ( bestMaxInv < 0.0 || maxInv < bestMaxInv ) {
+						bestMaxInv = maxInv;
+						inv.swap( trialInv );
+						std::copy( trialDirs.begin(), trialDirs.end(), dirs );
+					}
+				}
+				lobeInvs_.insert( lobeInvs_.end(), inv.begin(), inv.end() );
+			}
+
+			// Wh̒PW
+			const uint32_t cnum = maxLevel_ + 1;
+			legendreCoefs_.assign( cnum * cnum, 0.0 );
+			legendreCoefs_[ 0 ] = 1.0;
+			if ( maxLevel_ >= 1 )
+				legendreCoefs_[ cnum + 1 ] = 1.0;
+			for ( uint32_t l = 1; l < maxLevel_; ++l ) {
+				// (l+1)P_{l+1} = (2l+1) t P_l - l P_{l-1}
+				for ( uint32_t n = 0; n <= l + 1; ++n ) {
+					double v = ( n > 0 ? ( 2.0 * l + 1 ) * legendreCoefs_[ l * cnum + n - 1 ] : 0.0 ) - l * legendreCoefs_[ ( l - 1 ) * cnum + n ];
+					legendreCoefs_[ ( l + 1 ) * cnum + n ] = v / ( l + 1 );
+				}
+			}
+			lobeLevel_ = maxLevel_;
+		}
+
+		// p`ʌˉecoefsɉZ
+		//  _P (wE)^n d ӂ̐ϕ̑Q(Arvo 1995)ŋ߁Aђa[u̐ϕY_lm̌W𓾂
+		Error LightEstimater::projectPolygon( const AnalyticLight &light, double *coefs, uint32_t fnum ) {
+			const uint32_t vnum = (uint32_t)( light.vertices_.size() / 3 );
+			if ( vnum < 3 )
+				return Error( "polygon light needs 3 or more vertices." );
+			prepareZonalLobes();
+
+			// _PʋɎˉe
+			std::vector< double > verts( light.vertices_.begin(), light.vertices_.begin() + vnum * 3 );
+			for ( uint32_t i = 0; i < vnum; ++i ) {
+				if ( dot( &verts[ i * 3 ], &verts[ i * 3 ] ) <= 0.0 )
+					return Error( "polygon vertex is at the probe position." );
+				normalize( &verts[ i * 3 ] );
+			}
+
+			// eӂ̏in_sAn_ƒʂ̕tApxA~̖@nj
+			std::vector< double > edgeS( vnum * 3 ), edgeT( vnum * 3 ), edgeN( vnum * 3 ), edgeAngle( vnum );
+			for ( uint32_t i = 0; i < vnum; ++i ) {
+				const double *v0 = &verts[ i * 3 ];
+				const double *v1 = &verts[ ( ( i + 1 ) % vnum ) * 3 ];
+				double c = dot( v0, v1 );
+				double *s = &edgeS[ i * 3 ], *t = &edgeT[ i * 3 ], *n = &edgeN[ i * 3 ];
+				cross( v0, v1, n );
+				double sn = sqrt( dot( n, n ) );
+				if ( sn <= 1.0e-12 ) {
+					// kނӂ͊^Ȃ
+					edgeAngle[ i ] = 0.0;
+					for ( int k = 0; k < 3; ++k )
+						s[ k ] = t[ k ] = n[ k ] = 0.0;
+					continue;
+				}
+				for ( int k = 0; k < 3; ++k ) {
+					s[ k ] = v0[ k ];
+					t[ k ] = ( v1[ k ] - c * v0[ k ] ) / sn;
+					n[ k ] /= sn;
+				}
+				edgeAngle[ i ] = atan2( sn, c );
+			}
+
+			// ̊pi_0̐`j
+			double solidAngle = 0.0;
+			double center[ 3 ] = { 0.0, 0.0, 0.0 };
+			for ( uint32_t i = 0; i < vnum; ++i ) {
+				for ( int k = 0; k < 3; ++k )
+					center[ k ] += verts[ i * 3 + k ];
+			}
+			for ( uint32_t i = 1; i + 1 < vnum; ++i ) {
+				const double *a = &verts[ 0 ], *b = &verts[ i * 3 ], *c = &verts[ ( i + 1 ) * 3 ];
+				double bc[ 3 ];
+				cross( b, c, bc );
+				solidAngle += 2.0 * atan2( dot( a, bc ), 1.0 + dot( a, b ) + dot( b, c ) + dot( c, a ) );
+			}
+			solidAngle = fabs( solidAngle );
+			if ( dot( center, center ) <= 0.0 )
+				return Error( "invalid polygon light." );
+			normalize( center );
+
+			// ̕iSւ1[gƂȂ悤Ɂj
+			double orient = 0.0;
+			for ( uint32_t i = 0; i < vnum; ++i )
+				orient += dot( center, &edgeN[ i * 3 ] ) * edgeAngle[ i ];
+			const double sign = ( orient < 0.0 ? -1.0 : 1.0 );
+
+			const uint32_t cnum = maxLevel_ + 1;
+			std::vector< double > moments( cnum );	// _n = _P (wE)^n d
+			std::vector< double > edgeInts( vnum * cnum );	// C_i^n = _edge (wEu)^n d
+			std::vector< double > lobeInts( 2 * maxLevel_ + 1 );
+			const double rgb[ 3 ] = { light.r_, light.g_, light.b_ };
+			uint32_t invOffset = 0;
+			for ( uint32_t l = 0; l <= maxLevel_; ++l ) {
+				const uint32_t n = 2 * l + 1;
+				for ( uint32_t k = 0; k < n; ++k ) {
+					const double *w = &lobeDirs_[ ( l * l + k ) * 3 ];
+
+					// ӂ̐ϕ C^n = 1/n [ f^{n-1} g ]_0^ + (n-1)/n c^2 C^{n-2}
+					//  f = a cos + b sin, g = a sin - b cos
+					for ( uint32_t i = 0; i < vnum; ++i ) {
+						double *ci = &edgeInts[ i * cnum ];
+						const double a = dot( w, &edgeS[ i * 3 ] ), b = dot( w, &edgeT[ i * 3 ] );
+						const double th = edgeAngle[ i ];
+						const double f1 = a * cos( th ) + b * sin( th ), g1 = a * sin( th ) - b * cos( th );
+						const double f0 = a, g0 = -b;
+						const double c2 = a * a + b * b;
+						double pf1 = 1.0, pf0 = 1.0;	// f^{n-1}
+						ci[ 0 ] = th;
+						for ( uint32_t e = 1; e < cnum; ++e ) {
+							ci[ e ] = ( pf1 * g1 - pf0 * g0 + ( e >= 2 ? ( e - 1.0 ) * c2 * ci[ e - 2 ] : 0.0 ) ) / e;
+							pf1 *= f1;
+							pf0 *= f0;
+						}
+					}
+
+					// ʐϕ _n = 1/(n+1) [ (n-1) _{n-2} + _i (wEn_i) C_i^{n-1} ]
+					moments[ 0 ] = solidAngle;
+					for ( uint32_t e = 1; e < cnum; ++e ) {
+						double boundary = 0.0;
+						for ( uint32_t i = 0; i < vnum; ++i )
+							boundary += dot( w, &edgeN[ i * 3 ] ) * edgeInts[ i * cnum + e - 1 ];
+						moments[ e ] = ( ( e >= 2 ? ( e - 1.0 ) * moments[ e - 2 ] : 0.0 ) + sign * boundary ) / ( e + 1 );
+					}
+
+					// ђa[u̐ϕ _P P_l(wE) d
+					double v = 0.0;
+					for ( uint32_t e = 0; e <= l; ++e )
+						v += legendreCoefs_[ l * cnum + e ] * moments[ e ];
+					lobeInts[ k ] = v;
+				}
+
+				// Y_lm̌Wɕϊ
+				const double *inv = &lobeInvs_[ invOffset ];
+				const double s = ( 2.0 * l + 1 ) / ( 4.0 * pi_g );
+				for ( uint32_t m = 0; m < n; ++m ) {
+					double v = 0.0;
+					for ( uint32_t k = 0; k < n; ++k )
+						v += inv[ m * n + k ] * lobeInts[ k ];
+					for ( uint32_t c = 0; c < 3; ++c )
+						coefs[ c * fnum + l * l + m ] += rgb[ c ] * s * v;
+				}
+				invOffset += n * n;
+			}
+			return Error();
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#ifndef __ox_oxanalyticlight_h__
+#define __ox_oxanalyticlight_h__
+
+// ͓IȌ̎ˉe
+
+#include "oxsphericalharmonics.h"
+
+namespace OX {
+	namespace SphericalHarmonics {
+
+		// ͓IȌ
+		//  W̓v[uʒu_ƂEniY+VAth = acos(y), phi = atan2(z, x)j
+		struct AnalyticLight {
+			enum Type {
+				Type_Directional,	// s
+				Type_Point,			// _
+				Type_Sphere,		// ij
+				Type_Polygon,		// p`ʌ
+			};
+			Type type_ = Type_Directional;
+			double r_ = 0.0, g_ = 0.0, b_ = 0.0;	// sA_͋xBAp`ʌ͕ˋPx
+			double x_ = 0.0, y_ = 1.0, z_ = 0.0;	// s̗͌B_A͈ʒu
+			double radius_ = 0.0;					// ̔a
+			std::vector< double > vertices_;		// p`ʌ̒_(xyz)Bʑp`ŕӂ_ʂȂ
+
+			// s쐬
+			//  x, y, z : ̗
+			static AnalyticLight directional( double x, double y, double z, double r, double g, double b );
+
+			// _쐬i2Ōj
+			static AnalyticLight point( double x, double y, double z, double r, double g, double b );
+
+			// 쐬
+			//  aȏ̏ꍇ̓v[uދƂȂSlɌ
+			static AnalyticLight sphere( double x, double y, double z, double radius, double r, double g, double b );
+
+			// p`ʌ쐬
+			//  vertices : _W(xyz)̕сB3_ȏ
+			static AnalyticLight polygon( const std::vector< double > &vertices, double r, double g, double b );
+		};
+
+		// ͓IȌ̃p[^
+		//  sA_Y_lm̒lA͕ɉ]ыa֐A
+		//  p`ʌ͕ӂ̐ϕɂ`Ŏˉe邽߁AL[u}bvȂ
+		class LightEstimater : public Estimater {
+		public:
+			using Estimater::Estimater;
+			virtual ~LightEstimater() {}
+
+			// 
+			//  lights : ̔zBS̘aˉe
+			Error estimate( const AnalyticLight *lights, size_t lightNum, Result &res );
+			Error estimate( const std::vector< AnalyticLight > &lights, Result &res );
+
+		private:
+			// p`p̌W
+			void prepareZonalLobes();
+
+			// p`ʌˉecoefsɉZ
+			Error projectPolygon( const AnalyticLight &light, double *coefs, uint32_t fnum );
+
+			uint32_t lobeLevel_ = 0xffffffff;
+			std::vector< double > lobeDirs_;		// band̑ђa[u(xyz)
+			std::vector< double > lobeInvs_;		// bandY_lm([u)̋ts
+			std::vector< double > legendreCoefs_;	// Wh̒PW(l x n)
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,278 @@
+#include "oxblockcompression.h"
+#include "oximageutil.h"
+#include <string.h>
+
+namespace OX {
+	namespace {
+		// ubÑrbg̓ǂݍ݁iʃrbgj
+		class BitReader {
+		public:
+			BitReader( const uint8_t *block ) {
+				memcpy( &lo_, block, sizeof( lo_ ) );
+				memcpy( &hi_, block + 8, sizeof( hi_ ) );
+			}
+
+			uint32_t read( uint32_t num ) {
+				uint32_t v = 0;
+				for ( uint32_t i = 0; i < num; ++i, ++pos_ ) {
+					const uint64_t word = ( pos_ < 64 ? lo_ >> pos_ : hi_ >> ( pos_ - 64 ) );
+					v |= (uint32_t)( word & 1 ) << i;
+				}
+				return v;
+			}
+
+		private:
+			uint64_t lo_ = 0;
+			uint64_t hi_ = 0;
+			uint32_t pos_ = 0;
+		};
+
+		// BC6H̒[_̃rbgtB[h
+		//  ep_ : [_(w, x, y, z), ch_ : F(r, g, b), lsb_ : ސ擪rbg, num_ : rbg
+		struct BitField {
+			uint8_t ep_, ch_, lsb_, num_;
+		};
+
+		enum { W = 0, X = 1, Y = 2, Z = 3 };
+		enum { R = 0, G = 1, B = 2 };
+
+		// BC6H̃[h̏
+		struct BC6HMode {
+			uint8_t modeBits_;			// [hl
+			uint8_t isTwoRegion_;		// 2̈H
+			uint8_t isTransformed_;		// [_H
+			uint8_t endpointBits_;		// [_̃rbg
+			uint8_t deltaBits_[ 3 ];	// ̃rbg(r, g, b)
+			BitField fields_[ 40 ];		// ǂݍݏ̃rbgtB[hinum_ = 0ŏI[j
+		};
+
+		// t̃rbgiŏ̃rbgʁj̓rbgɕׂ
+		const BC6HMode bc6hModes_g[] = {
+			{ 0x00, 1, 1, 10, { 5, 5, 5 }, {
+				{ Y, G, 4, 1 }, { Y, B, 4, 1 }, { Z, B, 4, 1 }, { W, R, 0, 10 }, { W, G, 0, 10 }, { W, B, 0, 10 },
+				{ X, R, 0, 5 }, { Z, G, 4, 1 }, { Y, G, 0, 4 }, { X, G, 0, 5 }, { Z, B, 0, 1 }, { Z, G, 0, 4 },
+				{ X, B, 0, 5 }, { Z, B, 1, 1 }, { Y, B, 0, 4 }, { Y, R, 0, 5 }, { Z, B, 2, 1 }, { Z, R, 0, 5 },
+				{ Z, B, 3, 1 } } },
+			{ 0x01, 1, 1, 7, { 6, 6, 6 }, {
+				{ Y, G, 5, 1 }, { Z, G, 4, 1 }, { Z, G, 5, 1 }, { W, R, 0, 7 }, { Z, B, 0, 1 }, { Z, B, 1, 1 },
+				{ Y, B, 4, 1 }, { W, G, 0, 7 }, { Y, B, 5, 1 }, { Z, B, 2, 1 }, { Y, G, 4, 1 }, { W, B, 0, 7 },
+				{ Z, B, 3, 1 }, { Z, B, 5, 1 }, { Z, B, 4, 1 }, { X, R, 0, 6 }, { Y, G, 0, 4 }, { X, G, 0, 6 },
+				{ Z, G, 0, 4 }, { X, B, 0, 6 }, { Y, B, 0, 4 }, { Y, R, 0, 6 }, { Z, R, 0, 6 } } },
+			{ 0x02, 1, 1, 11, { 5, 4, 4 }, {
+				{ W, R, 0, 10 }, { W, G, 0, 10 }, { W, B, 0, 10 }, { X, R, 0, 5 }, { W, R, 10, 1 }, { Y, G, 0, 4 },
+				{ X, G, 0, 4 }, { W, G, 10, 1 }, { Z, B, 0, 1 }, { Z, G, 0, 4 }, { X, B, 0, 4 }, { W, B, 10, 1 },
+				{ Z, B, 1, 1 }, { Y, B, 0, 4 }, { Y, R, 0, 5 }, { Z, B, 2, 1 }, { Z, R, 0, 5 }, { Z, B, 3, 1 } } },
+			{ 0x06, 1, 1, 11, { 4, 5, 4 }, {
+				{ W, R, 0, 10 }, { W, G, 0, 10 }, { W, B, 0, 10 }, { X, R, 0, 4 }, { W, R, 10, 1 }, { Z, G, 4, 1 },
+				{ Y, G, 0, 4 }, { X, G, 0, 5 }, { W, G, 10, 1 }, { Z, G, 0, 4 }, { X, B, 0, 4 }, { W, B, 10, 1 },
+				{ Z, B, 1, 1 }, { Y, B, 0, 4 }, { Y, R, 0, 4 }, { Z, B, 0, 1 }, { Z, B, 2, 1 }, { Z, R, 0, 4 },
+				{ Y, G, 4, 1 }, { Z, B, 3, 1 } } },
+			{ 0x0a, 1, 1, 11, { 4, 4, 5 }, {
+				{ W, R, 0, 10 }, { W, G, 0, 10 }, { W, B, 0, 10 }, { X, R, 0, 4 }, { W, R, 10, 1 }, { Y, B, 4, 1 },
+				{ Y, G, 0, 4 }, { X, G, 0, 4 }, { W, G, 10, 1 }, { Z, B, 0, 1 }, { Z, G, 0, 4 }, { X, B, 0, 5 },
+				{ W, B, 10, 1 }, { Y, B, 0, 4 }, { Y, R, 0, 4 }, { Z, B, 1, 1 }, { Z, B, 2, 1 }, { Z, R, 0, 4 },
+				{ Z, B, 4, 1 }, { Z, B, 3, 1 } } },
+			{ 0x0e, 1, 1, 9, { 5, 5, 5 }, {
+				{ W, R, 0, 9 }, { Y, B, 4, 1 }, { W, G, 0, 9 }, { Y, G, 4, 1 }, { W, B, 0, 9 }, { Z, B, 4, 1 },
+				{ X, R, 0, 5 }, { Z, G, 4, 1 }, { Y, G, 0, 4 }, { X, G, 0, 5 }, { Z, B, 0, 1 }, { Z, G, 0, 4 },
+				{ X, B, 0, 5 }, { Z, B, 1, 1 }, { Y, B, 0, 4 }, { Y, R, 0, 5 }, { Z, B, 2, 1 }, { Z, R, 0, 5 },
+				{ Z, B, 3, 1 } } },
+			{ 0x12, 1, 1, 8, { 6, 5, 5 }, {
+				{ W, R, 0, 8 }, { Z, G, 4, 1 }, { Y, B, 4, 1 }, { W, G, 0, 8 }, { Z, B, 2, 1 }, { Y, G, 4, 1 },
+				{ W, B, 0, 8 }, { Z, B, 3, 1 }, { Z, B, 4, 1 }, { X, R, 0, 6 }, { Y, G, 0, 4 }, { X, G, 0, 5 },
+				{ Z, B, 0, 1 }, { Z, G, 0, 4 }, { X, B, 0, 5 }, { Z, B, 1, 1 }, { Y, B, 0, 4 }, { Y, R, 0, 6 },
+				{ Z, R, 0, 6 } } },
+			{ 0x16, 1, 1, 8, { 5, 6, 5 }, {
+				{ W, R, 0, 8 }, { Z, B, 0, 1 }, { Y, B, 4, 1 }, { W, G, 0, 8 }, { Y, G, 5, 1 }, { Y, G, 4, 1 },
+				{ W, B, 0, 8 }, { Z, G, 5, 1 }, { Z, B, 4, 1 }, { X, R, 0, 5 }, { Z, G, 4, 1 }, { Y, G, 0, 4 },
+				{ X, G, 0, 6 }, { Z, G, 0, 4 }, { X, B, 0, 5 }, { Z, B, 1, 1 }, { Y, B, 0, 4 }, { Y, R, 0, 5 },
+				{ Z, B, 2, 1 }, { Z, R, 0, 5 }, { Z, B, 3, 1 } } },
+			{ 0x1a, 1, 1, 8, { 5, 5, 6 }, {
+				{ W, R, 0, 8 }, { Z, B, 1, 1 }, { Y, B, 4, 1 }, { W, G, 0, 8 }, { Y, B, 5, 1 }, { Y, G, 4, 1 },
+				{ W, B, 0, 8 }, { Z, B, 5, 1 }, { Z, B, 4, 1 }, { X, R, 0, 5 }, { Z, G, 4, 1 }, { Y, G, 0, 4 },
+				{ X, G, 0, 5 }, { Z, B, 0, 1 }, { Z, G, 0, 4 }, { X, B, 0, 6 }, { Y, B, 0, 4 }, { Y, R, 0, 5 },
+				{ Z, B, 2, 1 }, { Z, R, 0, 5 }, { Z, B, 3, 1 } } },
+			{ 0x1e, 1, 0, 6, { 6, 6, 6 }, {
+				{ W, R, 0, 6 }, { Z, G, 4, 1 }, { Z, B, 0, 1 }, { Z, B, 1, 1 }, { Y, B, 4, 1 }, { W, G, 0, 6 },
+				{ Y, G, 5, 1 }, { Y, B, 5, 1 }, { Z, B, 2, 1 }, { Y, G, 4, 1 }, { W, B, 0, 6 }, { Z, G, 5, 1 },
+				{ Z, B, 3, 1 }, { Z, B, 5, 1 }, { Z, B, 4, 1 }, { X, R, 0, 6 }, { Y, G, 0, 4 }, { X, G, 0, 6 },
+				{ Z, G, 0, 4 }, { X, B, 0, 6 }, { Y, B, 0, 4 }, { Y, R, 0, 6 }, { Z, R, 0, 6 } } },
+			{ 0x03, 0, 0, 10, { 10, 10, 10 }, {
+				{ W, R, 0, 10 }, { W, G, 0, 10 }, { W, B, 0, 10 }, { X, R, 0, 10 }, { X, G, 0, 10 }, { X, B, 0, 10 } } },
+			{ 0x07, 0, 1, 11, { 9, 9, 9 }, {
+				{ W, R, 0, 10 }, { W, G, 0, 10 }, { W, B, 0, 10 }, { X, R, 0, 9 }, { W, R, 10, 1 }, { X, G, 0, 9 },
+				{ W, G, 10, 1 }, { X, B, 0, 9 }, { W, B, 10, 1 } } },
+			{ 0x0b, 0, 1, 12, { 8, 8, 8 }, {
+				{ W, R, 0, 10 }, { W, G, 0, 10 }, { W, B, 0, 10 }, { X, R, 0, 8 }, { W, R, 11, 1 }, { W, R, 10, 1 },
+				{ X, G, 0, 8 }, { W, G, 11, 1 }, { W, G, 10, 1 }, { X, B, 0, 8 }, { W, B, 11, 1 }, { W, B, 10, 1 } } },
+			{ 0x0f, 0, 1, 16, { 4, 4, 4 }, {
+				{ W, R, 0, 10 }, { W, G, 0, 10 }, { W, B, 0, 10 }, { X, R, 0, 4 },
+				{ W, R, 15, 1 }, { W, R, 14, 1 }, { W, R, 13, 1 }, { W, R, 12, 1 }, { W, R, 11, 1 }, { W, R, 10, 1 },
+				{ X, G, 0, 4 },
+				{ W, G, 15, 1 }, { W, G, 14, 1 }, { W, G, 13, 1 }, { W, G, 12, 1 }, { W, G, 11, 1 }, { W, G, 10, 1 },
+				{ X, B, 0, 4 },
+				{ W, B, 15, 1 }, { W, B, 14, 1 }, { W, B, 13, 1 }, { W, B, 12, 1 }, { W, B, 11, 1 }, { W, B, 10, 1 } } },
+		};
+
+		// 2̈̕`ieNZï1Ȃrbgi1j
+		const uint16_t bc6hPartitions_g[ 32 ] = {
+			0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+			0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+			0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+			0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+		};
+
+		// 2̗̈̈1̃AJ[eNZï0͏ɃeNZ0j
+		const uint8_t bc6hAnchors_g[ 32 ] = {
+			15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+			15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+		};
+
+		const int32_t bc6hWeights3_g[ 8 ] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+		const int32_t bc6hWeights4_g[ 16 ] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		int32_t signExtend( int32_t v, uint32_t bits ) {
+			const int32_t shift = 32 - bits;
+			return (int32_t)( (uint32_t)v << shift ) >> shift;
+		}
+
+		// [_16bitɋtʎq
+		int32_t unquantize( int32_t v, uint32_t bits, bool isSigned ) {
+			if ( isSigned == false ) {
+				if ( bits >= 15 || v == 0 )
+					return v;
+				if ( v == ( 1 << bits ) - 1 )
+					return 0xFFFF;
+				return ( ( v << 16 ) + 0x8000 ) >> bits;
+			}
+			if ( bits >= 16 )
+				return v;
+			const bool negative = ( v < 0 );
+			int32_t a = ( negative ? -v : v );
+			int32_t u;
+			if ( a == 0 )
+				u = 0;
+			else if ( a >= ( 1 << ( bits - 1 ) ) - 1 )
+				u = 0x7FFF;
+			else
+				u = ( ( a << 15 ) + 0x4000 ) >> ( bits - 1 );
+			return ( negative ? -u : u );
+		}
+
+		// Ԍʂ𔼐x_
+		float finishUnquantize( int32_t v, bool isSigned ) {
+			if ( isSigned == false )
+				return ImageUtil::halfToFloat( (uint16_t)( ( v * 31 ) >> 6 ) );
+			uint16_t s = 0;
+			if ( v < 0 ) {
+				s = 0x8000;
+				v = ( ( -v ) * 31 ) >> 5;
+			} else {
+				v = ( v * 31 ) >> 5;
+			}
+			return ImageUtil::halfToFloat( (uint16_t)( s | v ) );
+		}
+	}
+
+	// BC1̃ubÑpbgƃCfbNX擾
+	void BlockCompression::decodeBC1Palette( const uint8_t *block, float *palette, uint8_t *indices ) {
+		const uint16_t c0 = block[ 0 ] | ( block[ 1 ] << 8 );
+		const uint16_t c1 = block[ 2 ] | ( block[ 3 ] << 8 );
+		const uint16_t cs[ 2 ] = { c0, c1 };
+		for ( int i = 0; i < 2; ++i ) {
+			palette[ i * 4 + 0 ] = ( ( cs[ i ] >> 11 ) & 0x1f ) * ( 1.0f / 31.0f );
+			palette[ i * 4 + 1 ] = ( ( cs[ i ] >> 5 ) & 0x3f ) * ( 1.0f / 63.0f );
+			palette[ i * 4 + 2 ] = ( cs[ i ] & 0x1f ) * ( 1.0f / 31.0f );
+			palette[ i * 4 + 3 ] = 1.0f;
+		}
+		for ( int c = 0; c < 3; ++c ) {
+			const float p0 = palette[ c ], p1 = palette[ 4 + c ];
+			if ( c0 > c1 ) {
+				palette[ 8 + c ] = ( 2.0f * p0 + p1 ) * ( 1.0f / 3.0f );
+				palette[ 12 + c ] = ( p0 + 2.0f * p1 ) * ( 1.0f / 3.0f );
+			} else {
+				palette[ 8 + c ] = ( p0 + p1 ) * 0.5f;
+				palette[ 12 + c ] = 0.0f;
+			}
+		}
+		palette[ 11 ] = 1.0f;
+		palette[ 15 ] = ( c0 > c1 ? 1.0f : 0.0f );
+
+		const uint32_t bits = block[ 4 ] | ( block[ 5 ] << 8 ) | ( block[ 6 ] << 16 ) | ( (uint32_t)block[ 7 ] << 24 );
+		for ( int i = 0; i < 16; ++i )
+			indices[ i ] = ( bits >> ( i * 2 ) ) & 3;
+	}
+
+	// BC1̃ubNWJ
+	void BlockCompression::decodeBC1( const uint8_t *block, float *rgba ) {
+		float palette[ 16 ];
+		uint8_t indices[ 16 ];
+		decodeBC1Palette( block, palette, indices );
+		for ( int i = 0; i < 16; ++i )
+			memcpy( rgba + i * 4, palette + indices[ i ] * 4, sizeof( float ) * 4 );
+	}
+
+	// BC6H̃ubNWJ
+	void BlockCompression::decodeBC6H( const uint8_t *block, bool isSigned, float *rgba ) {
+		BitReader reader( block );
+		uint32_t modeBits = reader.read( 2 );
+		if ( modeBits > 1 )
+			modeBits |= reader.read( 3 ) << 2;
+
+		const BC6HMode *mode = 0;
+		for ( const auto &m : bc6hModes_g ) {
+			if ( m.modeBits_ == modeBits ) {
+				mode = &m;
+				break;
+			}
+		}
+		if ( mode == 0 ) {
+			for ( int i = 0; i < 16; ++i ) {
+				rgba[ i * 4 + 0 ] = rgba[ i * 4 + 1 ] = rgba[ i * 4 + 2 ] = 0.0f;
+				rgba[ i * 4 + 3 ] = 1.0f;
+			}
+			return;
+		}
+
+		// [_ǂݍ
+		int32_t ep[ 4 ][ 3 ] = {};
+		for ( const BitField *f = mode->fields_; f->num_ != 0; ++f )
+			ep[ f->ep_ ][ f->ch_ ] |= (int32_t)reader.read( f->num_ ) << f->lsb_;
+		const uint32_t partition = ( mode->isTwoRegion_ ? reader.read( 5 ) : 0 );
+		const uint32_t epNum = ( mode->isTwoRegion_ ? 4 : 2 );
+
+		// gƍ̕
+		const uint32_t bits = mode->endpointBits_;
+		for ( int c = 0; c < 3; ++c ) {
+			if ( isSigned )
+				ep[ 0 ][ c ] = signExtend( ep[ 0 ][ c ], bits );
+			for ( uint32_t e = 1; e < epNum; ++e ) {
+				if ( isSigned || mode->isTransformed_ )
+					ep[ e ][ c ] = signExtend( ep[ e ][ c ], mode->deltaBits_[ c ] );
+				if ( mode->isTransformed_ ) {
+					ep[ e ][ c ] = ( ep[ e ][ c ] + ep[ 0 ][ c ] ) & ( ( 1 << bits ) - 1 );
+					if ( isSigned )
+						ep[ e ][ c ] = signExtend( ep[ e ][ c ], bits );
+				}
+			}
+			for ( uint32_t e = 0; e < epNum; ++e )
+				ep[ e ][ c ] = unquantize( ep[ e ][ c ], bits, isSigned );
+		}
+
+		// CfbNXǂݍŕ
+		const uint16_t shape = ( mode->isTwoRegion_ ? bc6hPartitions_g[ partition ] : 0 );
+		const uint32_t anchor = ( mode->isTwoRegion_ ? bc6hAnchors_g[ partition ] : 0 );
+		const uint32_t indexBits = ( mode->isTwoRegion_ ? 3 : 4 );
+		const int32_t *weights = ( mode->isTwoRegion_ ? bc6hWeights3_g : bc6hWeights4_g );
+		for ( uint32_t i = 0; i < 16; ++i ) {
+			const uint32_t region = ( shape >> i ) & 1;
+			const bool isAnchor = ( i == 0 || ( region == 1 && i == anchor ) );
+			const int32_t w = weights[ reader.read( isAnchor ? indexBits - 1 : indexBits ) ];
+			const int32_t *e0 = ep[ region * 2 ];
+			const int32_t *e1 = ep[ region * 2 + 1 ];
+			for ( int c = 0; c < 3; ++c )
+				rgba[ i * 4 + c ] = finishUnquantize( ( e0[ c ] * ( 64 - w ) + e1[ c ] * w + 32 ) >> 6, isSigned );
+			rgba[ i * 4 + 3 ] = 1.0f;
+		}
+	}
+}
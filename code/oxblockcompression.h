@@ -0,0 +1,30 @@
+#ifndef __ox_oxblockcompression_h__
+#define __ox_oxblockcompression_h__
+
+// ubNk(BC1ABC6H)̓WJ
+
+#include <stdint.h>
+
+namespace OX {
+	// ubNk̓WJ
+	//  4x4eNZ̃ubNPʂœWJBeNZ̕т̓ubN̍sD
+	class BlockCompression {
+	public:
+		// BC1̃ubÑpbgƃCfbNX擾
+		//  palette : 4FRGBA(0`1)B3F[h̃CfbNX3͓ȍ
+		//  indices : 16eNZ̃pbg̃CfbNX
+		static void decodeBC1Palette( const uint8_t *block, float *palette, uint8_t *indices );
+
+		// BC1̃ubNWJ
+		//  rgba : 16 * 4̏o͐
+		static void decodeBC1( const uint8_t *block, float *rgba );
+
+		// BC6H̃ubNWJ
+		//  isSigned : ť`(BC6H_SF16)H
+		//  rgba     : 16 * 4̏o͐BAt@1
+		//  \񂳂ꂽ[h̃ubN0ɂȂ
+		static void decodeBC6H( const uint8_t *block, bool isSigned, float *rgba );
+	};
+}
+
+#endif
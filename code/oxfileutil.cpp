@@ -1,5 +1,14 @@
 #include "oxfileutil.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 
 namespace OX {
 	// t@CpXgq擾
@@ -38,4 +47,66 @@ namespace OX {
 		}
 		return path.substr( dirPos, count );
 	}
+
+
+
+	MappedFile::~MappedFile() {
+		close();
+	}
+
+	// t@CJă}bv
+	//  }bv̓t@CnhĂr[͗L
+	bool MappedFile::open( const char *filePath ) {
+		close();
+		if ( filePath == 0 )
+			return false;
+#ifdef _WIN32
+		HANDLE file = CreateFileA( filePath, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0 );
+		if ( file == INVALID_HANDLE_VALUE )
+			return false;
+		LARGE_INTEGER size;
+		if ( GetFileSizeEx( file, &size ) == FALSE || size.QuadPart == 0 ) {
+			CloseHandle( file );
+			return false;
+		}
+		HANDLE mapping = CreateFileMappingA( file, 0, PAGE_READONLY, 0, 0, 0 );
+		CloseHandle( file );
+		if ( mapping == 0 )
+			return false;
+		void *p = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+		CloseHandle( mapping );
+		if ( p == 0 )
+			return false;
+		size_ = (uint64_t)size.QuadPart;
+#else
+		int fd = ::open( filePath, O_RDONLY );
+		if ( fd < 0 )
+			return false;
+		struct stat st;
+		if ( fstat( fd, &st ) != 0 || st.st_size == 0 ) {
+			::close( fd );
+			return false;
+		}
+		void *p = mmap( 0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		::close( fd );
+		if ( p == MAP_FAILED )
+			return false;
+		size_ = (uint64_t)st.st_size;
+#endif
+		data_ = (const uint8_t*)p;
+		return true;
+	}
+
+	// }bv
+	void MappedFile::close() {
+		if ( data_ == 0 )
+			return;
+#ifdef _WIN32
+		UnmapViewOfFile( data_ );
+#else
+		munmap( (void*)data_, (size_t)size_ );
+#endif
+		data_ = 0;
+		size_ = 0;
+	}
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 // t@C[eBeB
 
 #include <string>
+#include <stdint.h>
 
 namespace OX {
 	class FileUtil {
@@ -17,6 +18,34 @@ namespace OX {
 		//  onlyFileName : t@Cx[X݂̂ɂHfalsȅꍇ̓fBNgtL
 		static std::string getBaseName( const std::string &path, bool onlyFileName = true );
 	};
+
+	// ǂݍݐp̃}bvht@C
+	//  t@C̓e𕡐ɃAhXԂɊ蓖Ă
+	class MappedFile {
+	public:
+		MappedFile() {}
+		~MappedFile();
+
+		// t@CJă}bv
+		//  ߂l : JȂA܂͋̃t@C̏ꍇfalse
+		bool open( const char *filePath );
+
+		// }bv
+		void close();
+
+		// 擪AhX擾
+		const uint8_t *data() const { return data_; }
+
+		// t@CTCY擾
+		uint64_t size() const { return size_; }
+
+	private:
+		MappedFile( const MappedFile & ) = delete;
+		MappedFile &operator =( const MappedFile & ) = delete;
+
+		const uint8_t *data_ = 0;
+		uint64_t size_ = 0;
+	};
 }
 
 #endif
\ No newline at end of file
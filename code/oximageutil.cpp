@@ -1,5 +1,6 @@
 #include "oximageutil.h"
 #include "oxfileutil.h"
+#include "oxjpegdecoder.h"
 #include <algorithm>
 #include <cctype>
 
@@ -9,17 +10,39 @@
 #include "stb_image_write.h"
 
 #include <fstream>
+#include <math.h>
+#include <atomic>
+#include <thread>
 
 namespace OX {
 
+	// 1̃oCg擾
+	uint8_t ImageBlock::PixelFormat::bytePerComponent() const {
+		switch ( type_ ) {
+		case ComponentType_U16:
+		case ComponentType_F16:
+			return 2;
+		case ComponentType_F32:
+			return 4;
+		default:
+			return 1;
+		}
+	}
+
+	// 1J[̃oCg擾
+	uint8_t ImageBlock::PixelFormat::bytePerColor() const {
+		return channelNum_ * bytePerComponent();
+	}
+
 	struct ImageBlock::Body {
 		Body() {}
 		virtual ~Body() {}
 		uint8_t *block_ = 0;
-		uint32_t size_ = 0;
+		uint64_t size_ = 0;
 		uint32_t width_ = 0;
 		uint32_t height_ = 0;
-		uint32_t bytePerColor_ = 0;
+		uint64_t pitch_ = 0;
+		ImageBlock::PixelFormat format_;
 
 	private:
 		Body( const Body & ) = delete;
@@ -30,7 +53,7 @@ namespace OX {
 	ImageBlock::~ImageBlock() {}
 
 	// ubNTCY擾
-	uint32_t ImageBlock::size() const {
+	uint64_t ImageBlock::size() const {
 		return body_->size_;
 	}
 
@@ -39,6 +62,16 @@ namespace OX {
 		return body_->block_;
 	}
 
+	// 1s̃oCg擾
+	uint64_t ImageBlock::pitch() const {
+		return body_->pitch_;
+	}
+
+	// ws̐擪AhX擾
+	uint8_t *ImageBlock::row( uint32_t y ) const {
+		return body_->block_ + body_->pitch_ * y;
+	}
+
 	// C[WH
 	bool ImageBlock::isExist() const {
 		return body_->size_ > 0;
@@ -54,7 +87,22 @@ namespace OX {
 
 	// 1J[̃oCg擾
 	uint8_t ImageBlock::bytePerColor() const {
-		return body_->bytePerColor_;
+		return body_->format_.bytePerColor();
+	}
+
+	// 1J[̃`l擾
+	uint8_t ImageBlock::channelNum() const {
+		return body_->format_.channelNum_;
+	}
+
+	// ̌^擾
+	ImageBlock::ComponentType ImageBlock::componentType() const {
+		return body_->format_.type_;
+	}
+
+	// sNZtH[}bg擾
+	const ImageBlock::PixelFormat &ImageBlock::format() const {
+		return body_->format_;
 	}
 
 
@@ -62,58 +110,733 @@ namespace OX {
 	struct ImageBlockCustomBody : public ImageBlock::Body {
 		ImageBlockCustomBody() {}
 		virtual ~ImageBlockCustomBody() {
-			if ( block_ != 0 ) {
-				delete[] block_;
-			}
+			if ( block_ != 0 )
+				allocator_->deallocate( block_, size_ );
 		}
+		std::shared_ptr< Allocator > allocator_;	// mۂAP[^
 	};
 
 	// o͗pImageBlock
-	ImageBlockCustom::ImageBlockCustom( uint32_t w, uint32_t h, uint32_t bytePerColor, uint8_t *data ) : ImageBlock( new ImageBlockCustomBody ) {
-		body_->width_ = w;
-		body_->height_ = h;
-		body_->bytePerColor_ = bytePerColor;
-		body_->size_ = w * h * bytePerColor;
-		body_->block_ = new uint8_t[ body_->size_ ];
+	ImageBlockCustom::ImageBlockCustom( uint32_t w, uint32_t h, uint32_t bytePerColor, uint8_t *data ) : ImageBlockCustom( w, h, PixelFormat( bytePerColor, ComponentType_U8 ), data ) {
+	}
+
+	// ̌^w肵č쐬
+	ImageBlockCustom::ImageBlockCustom( uint32_t w, uint32_t h, uint32_t channelNum, ComponentType type, const void *data ) : ImageBlockCustom( w, h, PixelFormat( channelNum, type ), data ) {
+	}
+
+	// sNZtH[}bgw肵č쐬
+	ImageBlockCustom::ImageBlockCustom( uint32_t w, uint32_t h, const PixelFormat &format, const void *data, const std::shared_ptr< Allocator > &allocator ) : ImageBlock( new ImageBlockCustomBody ) {
+		ImageBlockCustomBody *body = static_cast< ImageBlockCustomBody* >( body_.get() );
+		body->pitch_ = (uint64_t)w * format.bytePerColor();
+		body->allocator_ = allocator;
+		body->block_ = (uint8_t*)allocator->allocate( body->pitch_ * h );
+		if ( body->block_ == 0 )
+			return;
+		body->width_ = w;
+		body->height_ = h;
+		body->format_ = format;
+		body->size_ = body->pitch_ * h;
 		if ( data )
-			memcpy( body_->block_, data, body_->size_ );
+			memcpy( body->block_, data, body->size_ );
 	}
 	ImageBlockCustom::~ImageBlockCustom() {}
+
+	// ĂяõQƂImageBlock
+	ImageBlockRef::ImageBlockRef( uint32_t w, uint32_t h, const PixelFormat &format, const void *data, uint64_t pitch ) : ImageBlock( new Body ) {
+		if ( data == 0 || w == 0 || h == 0 )
+			return;
+		body_->width_ = w;
+		body_->height_ = h;
+		body_->format_ = format;
+		body_->pitch_ = ( pitch ? pitch : w * format.bytePerColor() );
+		body_->size_ = body_->pitch_ * ( h - 1 ) + (uint64_t)w * format.bytePerColor();
+		body_->block_ = (uint8_t*)data;
+	}
+	ImageBlockRef::~ImageBlockRef() {}
 }
 
 
 namespace {
 	class ImageBlockBody : public OX::ImageBlock::Body {
 	public:
-		ImageBlockBody( unsigned char* data, uint32_t width, uint32_t height, uint32_t bytePerColor ) {
+		ImageBlockBody( unsigned char* data, uint32_t width, uint32_t height, const OX::ImageBlock::PixelFormat &format ) {
 			block_ = data;
-			size_ = width * height * bytePerColor;
+			format_ = format;
+			pitch_ = (uint64_t)width * format.bytePerColor();
+			size_ = pitch_ * height;
+			if ( OX::Memory::isLarge( size_ ) )
+				OX::Memory::adviseHugePage( block_, size_ );
 			width_ = width;
 			height_ = height;
-			bytePerColor_ = bytePerColor;
 		}
 		virtual ~ImageBlockBody() {
 			if ( block_ != 0 )
 				stbi_image_free( block_ );
 		}
 	};
+
+	// ̌^̓ǂݏ
+	struct ComponentU8 {
+		typedef uint8_t Type;
+		static float load( Type v ) { return v * ( 1.0f / 255.0f ); }
+		static Type store( float v ) { return (Type)( ( v < 0.0f ? 0.0f : ( v > 1.0f ? 1.0f : v ) ) * 255.0f + 0.5f ); }
+	};
+	struct ComponentU16 {
+		typedef uint16_t Type;
+		static float load( Type v ) { return v * ( 1.0f / 65535.0f ); }
+		static Type store( float v ) { return (Type)( ( v < 0.0f ? 0.0f : ( v > 1.0f ? 1.0f : v ) ) * 65535.0f + 0.5f ); }
+	};
+	struct ComponentF16 {
+		typedef uint16_t Type;
+		static float load( Type v ) { return OX::ImageUtil::halfToFloat( v ); }
+		static Type store( float v ) { return OX::ImageUtil::floatToHalf( v ); }
+	};
+	struct ComponentF32 {
+		typedef float Type;
+		static float load( Type v ) { return v; }
+		static Type store( float v ) { return v; }
+	};
+
+	// sRGBA̕_ɕϊ
+	template< class C, uint32_t CN >
+	void decodeRow( const uint8_t *src, uint32_t width, float *rgba ) {
+		const typename C::Type *s = (const typename C::Type*)src;
+		for ( uint32_t u = 0; u < width; ++u, s += CN, rgba += 4 ) {
+			if ( CN <= 2 ) {
+				rgba[ 0 ] = rgba[ 1 ] = rgba[ 2 ] = C::load( s[ 0 ] );
+				rgba[ 3 ] = ( CN == 2 ? C::load( s[ 1 ] ) : 1.0f );
+			} else {
+				rgba[ 0 ] = C::load( s[ 0 ] );
+				rgba[ 1 ] = C::load( s[ 1 ] );
+				rgba[ 2 ] = C::load( s[ 2 ] );
+				rgba[ 3 ] = ( CN == 4 ? C::load( s[ 3 ] ) : 1.0f );
+			}
+		}
+	}
+
+	// 32bit_RGBA͂̂܂܃Rs[
+	template<>
+	void decodeRow< ComponentF32, 4 >( const uint8_t *src, uint32_t width, float *rgba ) {
+		memcpy( rgba, src, sizeof( float ) * 4 * width );
+	}
+
+	// e[učsRGBA̕_ɕϊ
+	template< class C, uint32_t CN >
+	void decodeRowLUT( const uint8_t *src, uint32_t width, const float *lut, float *rgba ) {
+		const typename C::Type *s = (const typename C::Type*)src;
+		for ( uint32_t u = 0; u < width; ++u, s += CN, rgba += 4 ) {
+			if ( CN <= 2 ) {
+				rgba[ 0 ] = rgba[ 1 ] = rgba[ 2 ] = lut[ s[ 0 ] ];
+				rgba[ 3 ] = ( CN == 2 ? C::load( s[ 1 ] ) : 1.0f );
+			} else {
+				rgba[ 0 ] = lut[ s[ 0 ] ];
+				rgba[ 1 ] = lut[ s[ 1 ] ];
+				rgba[ 2 ] = lut[ s[ 2 ] ];
+				rgba[ 3 ] = ( CN == 4 ? C::load( s[ 3 ] ) : 1.0f );
+			}
+		}
+	}
+
+	// RGBA̕_sɕϊ
+	//  O[R̒lg
+	template< class C, uint32_t CN >
+	void encodeRow( const float *rgba, uint32_t width, uint8_t *dest ) {
+		typename C::Type *d = (typename C::Type*)dest;
+		for ( uint32_t u = 0; u < width; ++u, d += CN, rgba += 4 ) {
+			if ( CN <= 2 ) {
+				d[ 0 ] = C::store( rgba[ 0 ] );
+				if ( CN == 2 )
+					d[ 1 ] = C::store( rgba[ 3 ] );
+			} else {
+				d[ 0 ] = C::store( rgba[ 0 ] );
+				d[ 1 ] = C::store( rgba[ 1 ] );
+				d[ 2 ] = C::store( rgba[ 2 ] );
+				if ( CN == 4 )
+					d[ 3 ] = C::store( rgba[ 3 ] );
+			}
+		}
+	}
+
+	template< class C >
+	OX::ImageUtil::RowDecoder selectDecoder( uint32_t channelNum ) {
+		static const OX::ImageUtil::RowDecoder decoders[] = {
+			decodeRow< C, 1 >, decodeRow< C, 2 >, decodeRow< C, 3 >, decodeRow< C, 4 >,
+		};
+		return ( channelNum >= 1 && channelNum <= 4 ? decoders[ channelNum - 1 ] : 0 );
+	}
+
+	template< class C >
+	OX::ImageUtil::RowDecoderLUT selectDecoderLUT( uint32_t channelNum ) {
+		static const OX::ImageUtil::RowDecoderLUT decoders[] = {
+			decodeRowLUT< C, 1 >, decodeRowLUT< C, 2 >, decodeRowLUT< C, 3 >, decodeRowLUT< C, 4 >,
+		};
+		return ( channelNum >= 1 && channelNum <= 4 ? decoders[ channelNum - 1 ] : 0 );
+	}
+
+	template< class C >
+	OX::ImageUtil::RowEncoder selectEncoder( uint32_t channelNum ) {
+		static const OX::ImageUtil::RowEncoder encoders[] = {
+			encodeRow< C, 1 >, encodeRow< C, 2 >, encodeRow< C, 3 >, encodeRow< C, 4 >,
+		};
+		return ( channelNum >= 1 && channelNum <= 4 ? encoders[ channelNum - 1 ] : 0 );
+	}
+}
+
+namespace {
+	// PNG̕GR[h
+	//  s̃tB^ƈkіɍsAіIDAT`NƂČq
+	const uint32_t pngStripBytes_g = 256 * 1024;	// ̑т̃oCg̖ڈ
+	const uint32_t deflateWindow_g = 32768;			// deflate̎QƉ\ȋ
+	const uint32_t deflateHashBits_g = 15;
+	const uint32_t deflateChainNum_g = 32;			// vTnbV`F[̒
+	const uint32_t deflateMaxMatch_g = 258;
+
+	const uint16_t lengthBase_g[ 29 ] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const uint8_t lengthExtra_g[ 29 ] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const uint16_t distBase_g[ 30 ] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const uint8_t distExtra_g[ 30 ] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	// deflatěŒnt}̕\
+	//  LSBt@[Xgŏ悤rbg𔽓]Ď
+	struct FixedHuffman {
+		uint16_t litCode_[ 288 ];
+		uint8_t litBits_[ 288 ];
+		uint8_t distCode_[ 30 ];
+		uint8_t lengthSym_[ deflateMaxMatch_g + 1 ];	// v璷̕ԍ
+		uint8_t distSym_[ 512 ];						// d狗̕ԍB256ȉd - 1Aȏ256 + ( ( d - 1 ) >> 7 )
+
+		FixedHuffman() {
+			for ( uint32_t n = 0; n < 288; ++n ) {
+				uint32_t code, bits;
+				if ( n <= 143 ) {
+					code = 0x30 + n;
+					bits = 8;
+				} else if ( n <= 255 ) {
+					code = 0x190 + n - 144;
+					bits = 9;
+				} else if ( n <= 279 ) {
+					code = n - 256;
+					bits = 7;
+				} else {
+					code = 0xc0 + n - 280;
+					bits = 8;
+				}
+				litCode_[ n ] = (uint16_t)reverse( code, bits );
+				litBits_[ n ] = (uint8_t)bits;
+			}
+			for ( uint32_t n = 0; n < 30; ++n ) {
+				distCode_[ n ] = (uint8_t)reverse( n, 5 );
+				for ( uint32_t d = distBase_g[ n ]; d < distBase_g[ n ] + ( 1u << distExtra_g[ n ] ); ++d )
+					distSym_[ d <= 256 ? d - 1 : 256 + ( ( d - 1 ) >> 7 ) ] = (uint8_t)n;
+			}
+			for ( uint32_t n = 0; n < 29; ++n ) {
+				for ( uint32_t len = lengthBase_g[ n ]; len < lengthBase_g[ n ] + ( 1u << lengthExtra_g[ n ] ) && len <= deflateMaxMatch_g; ++len )
+					lengthSym_[ len ] = (uint8_t)n;
+			}
+		}
+
+		static uint32_t reverse( uint32_t code, uint32_t bits ) {
+			uint32_t res = 0;
+			for ( uint32_t i = 0; i < bits; ++i ) {
+				res = ( res << 1 ) | ( code & 1 );
+				code >>= 1;
+			}
+			return res;
+		}
+
+		static const FixedHuffman &get() {
+			static const FixedHuffman table;
+			return table;
+		}
+	};
+
+	// LSBt@[Xg̃rbg
+	class BitWriter {
+	public:
+		BitWriter( std::vector< uint8_t > &out ) : out_( out ) {}
+
+		void put( uint32_t bits, uint32_t num ) {
+			buf_ |= (uint64_t)bits << num_;
+			num_ += num;
+			while ( num_ >= 8 ) {
+				out_.push_back( (uint8_t)buf_ );
+				buf_ >>= 8;
+				num_ -= 8;
+			}
+		}
+
+		// oCgE܂0Ŗ߂
+		void align() {
+			if ( num_ > 0 )
+				put( 0, 8 - num_ );
+		}
+
+	private:
+		std::vector< uint8_t > &out_;
+		uint64_t buf_ = 0;
+		uint32_t num_ = 0;
+	};
+
+	// тŒnt}deflateubNɈkoutɒǉ
+	//  src[ -dictSize, 0 )͑Ȏт̖ŁAv̎QƐƂĂ̂ݎg
+	//  Ō̑шȊO͋̔񈳏kubNitbVjŏIȂтoCgEq悤ɂ
+	void deflateStrip( const uint8_t *src, uint64_t size, uint32_t dictSize, bool isLast, std::vector< uint8_t > &out ) {
+		const FixedHuffman &huff = FixedHuffman::get();
+		const uint8_t *base = src - dictSize;
+		const uint64_t total = dictSize + size;
+		const uint32_t hashMask = ( 1u << deflateHashBits_g ) - 1;
+		std::vector< int64_t > head( (size_t)hashMask + 1, -1 );
+		std::vector< int64_t > prev( total );
+		auto insert = [ & ]( uint64_t p ) {
+			if ( p + 2 >= total )
+				return;
+			const uint32_t h = ( ( base[ p ] << 10 ) ^ ( base[ p + 1 ] << 5 ) ^ base[ p + 2 ] ) & hashMask;
+			prev[ p ] = head[ h ];
+			head[ h ] = (int64_t)p;
+		};
+		for ( uint64_t p = 0; p < dictSize; ++p )
+			insert( p );
+
+		BitWriter writer( out );
+		writer.put( isLast ? 1 : 0, 1 );	// BFINAL
+		writer.put( 1, 2 );					// BTYPE = Œnt}
+		uint64_t p = dictSize;
+		while ( p < total ) {
+			// nbV`F[Œ̈vT
+			uint32_t best = 0;
+			uint32_t bestDist = 0;
+			if ( p + 2 < total ) {
+				const uint32_t maxLen = (uint32_t)std::min< uint64_t >( deflateMaxMatch_g, total - p );
+				const uint32_t h = ( ( base[ p ] << 10 ) ^ ( base[ p + 1 ] << 5 ) ^ base[ p + 2 ] ) & hashMask;
+				int64_t c = head[ h ];
+				for ( uint32_t n = 0; n < deflateChainNum_g && c >= 0 && p - c <= deflateWindow_g; ++n, c = prev[ c ] ) {
+					const uint8_t *a = base + c;
+					const uint8_t *b = base + p;
+					uint32_t len = 0;
+					while ( len < maxLen && a[ len ] == b[ len ] )
+						++len;
+					if ( len > best ) {
+						best = len;
+						bestDist = (uint32_t)( p - c );
+						if ( len == maxLen )
+							break;
+					}
+				}
+			}
+
+			if ( best >= 3 ) {
+				const uint32_t ls = huff.lengthSym_[ best ];
+				writer.put( huff.litCode_[ 257 + ls ], huff.litBits_[ 257 + ls ] );
+				if ( lengthExtra_g[ ls ] > 0 )
+					writer.put( best - lengthBase_g[ ls ], lengthExtra_g[ ls ] );
+				const uint32_t ds = huff.distSym_[ bestDist <= 256 ? bestDist - 1 : 256 + ( ( bestDist - 1 ) >> 7 ) ];
+				writer.put( huff.distCode_[ ds ], 5 );
+				if ( distExtra_g[ ds ] > 0 )
+					writer.put( bestDist - distBase_g[ ds ], distExtra_g[ ds ] );
+				for ( uint32_t i = 0; i < best; ++i )
+					insert( p + i );
+				p += best;
+			} else {
+				writer.put( huff.litCode_[ base[ p ] ], huff.litBits_[ base[ p ] ] );
+				insert( p );
+				++p;
+			}
+		}
+		writer.put( huff.litCode_[ 256 ], huff.litBits_[ 256 ] );	// ubN̏I
+		if ( isLast == false ) {
+			writer.put( 0, 3 );	// BFINAL = 0, BTYPE = 񈳏k
+			writer.align();
+			const uint8_t empty[] = { 0x00, 0x00, 0xff, 0xff };
+			out.insert( out.end(), empty, empty + 4 );
+		} else {
+			writer.align();
+		}
+	}
+
+	// PNG̍s̃tB^
+	//  5ނ̃tB^̌ʂ̕t̐Βl̘aŏ̂̂Iԁistb_image_writeƓj
+	//  prev : O̍sB擪̍s0
+	//  dest : tB^̎ނ1oCgrowBytesoCg
+	void filterPNGRow( const uint8_t *row, const uint8_t *prev, uint32_t rowBytes, uint32_t bpp, uint8_t *work, uint8_t *dest ) {
+		int64_t bestSum = -1;
+		uint32_t bestType = 0;
+		for ( uint32_t type = 0; type < 5; ++type ) {
+			uint8_t *out = work + (uint64_t)type * rowBytes;
+			int64_t sum = 0;
+			for ( uint32_t i = 0; i < rowBytes; ++i ) {
+				const int32_t a = ( i >= bpp ? row[ i - bpp ] : 0 );
+				const int32_t b = ( prev ? prev[ i ] : 0 );
+				const int32_t c = ( prev && i >= bpp ? prev[ i - bpp ] : 0 );
+				int32_t pred = 0;
+				switch ( type ) {
+				case 1: pred = a; break;
+				case 2: pred = b; break;
+				case 3: pred = ( a + b ) >> 1; break;
+				case 4: {
+					const int32_t pa = abs( b - c ), pb = abs( a - c ), pc = abs( a + b - 2 * c );
+					pred = ( pa <= pb && pa <= pc ? a : ( pb <= pc ? b : c ) );
+					break;
+				}
+				}
+				out[ i ] = (uint8_t)( row[ i ] - pred );
+				sum += abs( (int8_t)out[ i ] );
+			}
+			if ( bestSum < 0 || sum < bestSum ) {
+				bestSum = sum;
+				bestType = type;
+			}
+		}
+		dest[ 0 ] = (uint8_t)bestType;
+		memcpy( dest + 1, work + (uint64_t)bestType * rowBytes, rowBytes );
+	}
+
+	// rbOGfBA32bitǉ
+	void pushU32BE( std::vector< uint8_t > &out, uint32_t v ) {
+		out.push_back( (uint8_t)( v >> 24 ) );
+		out.push_back( (uint8_t)( v >> 16 ) );
+		out.push_back( (uint8_t)( v >> 8 ) );
+		out.push_back( (uint8_t)v );
+	}
+
+	// `NJnȉꏊƎށj
+	void beginChunk( std::vector< uint8_t > &out, const char *type ) {
+		pushU32BE( out, 0 );
+		out.insert( out.end(), type, type + 4 );
+	}
+
+	// `NiCRCj
+	//  start : beginChunkʒu
+	void endChunk( std::vector< uint8_t > &out, size_t start ) {
+		const uint32_t len = (uint32_t)( out.size() - start - 8 );
+		out[ start + 0 ] = (uint8_t)( len >> 24 );
+		out[ start + 1 ] = (uint8_t)( len >> 16 );
+		out[ start + 2 ] = (uint8_t)( len >> 8 );
+		out[ start + 3 ] = (uint8_t)len;
+		pushU32BE( out, stbiw__crc32( out.data() + start + 4, (int)( len + 4 ) ) );
+	}
+
+	// Adler-32
+	uint32_t adler32( const uint8_t *data, uint64_t size ) {
+		uint32_t s1 = 1, s2 = 0;
+		while ( size > 0 ) {
+			const uint64_t num = std::min< uint64_t >( size, 5552 );
+			for ( uint64_t i = 0; i < num; ++i ) {
+				s1 += data[ i ];
+				s2 += s1;
+			}
+			s1 %= 65521;
+			s2 %= 65521;
+			data += num;
+			size -= num;
+		}
+		return ( s2 << 16 ) | s1;
+	}
+
+	// Xbh߂
+	//  num : 0̏ꍇ̓n[hEFÃXbh
+	uint32_t resolveThreadNum( uint32_t num ) {
+		if ( num > 0 )
+			return num;
+		num = std::thread::hardware_concurrency();
+		return ( num > 0 ? num : 1 );
+	}
+
+	// ^XNĂяoXbhƍ쐬XbhŕSď
+	template< class Task >
+	void parallelFor( uint64_t taskNum, uint32_t threadNum, const Task &task ) {
+		std::atomic< uint64_t > next( 0 );
+		auto work = [ & ]() {
+			for ( ;; ) {
+				const uint64_t idx = next++;
+				if ( idx >= taskNum )
+					break;
+				task( idx );
+			}
+		};
+		std::vector< std::thread > threads;
+		for ( uint32_t i = 1; i < threadNum && i < taskNum; ++i )
+			threads.emplace_back( work );
+		work();
+		for ( auto &t : threads )
+			t.join();
+	}
 }
 
 namespace OX {
+	// sNZtH[}bgɑ΂s̕ϊ֐擾
+	ImageUtil::RowDecoder ImageUtil::getRowDecoder( const ImageBlock::PixelFormat &format ) {
+		switch ( format.type_ ) {
+		case ImageBlock::ComponentType_U8:	return selectDecoder< ComponentU8 >( format.channelNum_ );
+		case ImageBlock::ComponentType_U16:	return selectDecoder< ComponentU16 >( format.channelNum_ );
+		case ImageBlock::ComponentType_F16:	return selectDecoder< ComponentF16 >( format.channelNum_ );
+		case ImageBlock::ComponentType_F32:	return selectDecoder< ComponentF32 >( format.channelNum_ );
+		}
+		return 0;
+	}
+
+	ImageUtil::RowEncoder ImageUtil::getRowEncoder( const ImageBlock::PixelFormat &format ) {
+		switch ( format.type_ ) {
+		case ImageBlock::ComponentType_U8:	return selectEncoder< ComponentU8 >( format.channelNum_ );
+		case ImageBlock::ComponentType_U16:	return selectEncoder< ComponentU16 >( format.channelNum_ );
+		case ImageBlock::ComponentType_F16:	return selectEncoder< ComponentF16 >( format.channelNum_ );
+		case ImageBlock::ComponentType_F32:	return selectEncoder< ComponentF32 >( format.channelNum_ );
+		}
+		return 0;
+	}
+
+	// sNZtH[}bgɑ΂e[ut̍s̕ϊ֐擾
+	ImageUtil::RowDecoderLUT ImageUtil::getRowDecoderLUT( const ImageBlock::PixelFormat &format ) {
+		switch ( format.type_ ) {
+		case ImageBlock::ComponentType_U8:	return selectDecoderLUT< ComponentU8 >( format.channelNum_ );
+		case ImageBlock::ComponentType_U16:	return selectDecoderLUT< ComponentU16 >( format.channelNum_ );
+		default:
+			return 0;
+		}
+	}
+
+	// FԂ̃fR[he[u쐬
+	std::vector< float > ImageUtil::createDecodeTable( const ImageBlock::PixelFormat &format ) {
+		uint32_t num = 0;
+		if ( format.type_ == ImageBlock::ComponentType_U8 )
+			num = 256;
+		else if ( format.type_ == ImageBlock::ComponentType_U16 )
+			num = 65536;
+		std::vector< float > table( num );
+		for ( uint32_t i = 0; i < num; ++i )
+			table[ i ] = decodeColorSpace( (float)i / ( num - 1 ), format );
+		return table;
+	}
+
+	// FԂŃGR[hꂽljAl
+	float ImageUtil::decodeColorSpace( float v, const ImageBlock::PixelFormat &format ) {
+		if ( format.colorSpace_ == ImageBlock::ColorSpace_Linear )
+			return v;
+		if ( v <= 0.0f )
+			return 0.0f;
+		if ( format.colorSpace_ == ImageBlock::ColorSpace_SRGB )
+			return ( v <= 0.04045f ? v / 12.92f : powf( ( v + 0.055f ) / 1.055f, 2.4f ) );
+		return powf( v, format.gamma_ );
+	}
+
+	// jAlFԂŃGR[h
+	float ImageUtil::encodeColorSpace( float v, const ImageBlock::PixelFormat &format ) {
+		if ( format.colorSpace_ == ImageBlock::ColorSpace_Linear )
+			return v;
+		if ( v <= 0.0f )
+			return 0.0f;
+		if ( format.colorSpace_ == ImageBlock::ColorSpace_SRGB )
+			return ( v <= 0.0031308f ? v * 12.92f : 1.055f * powf( v, 1.0f / 2.4f ) - 0.055f );
+		return powf( v, 1.0f / format.gamma_ );
+	}
+
+	// _RGBARGBjAl
+	void ImageUtil::decodeColorSpaceRow( float *rgba, uint32_t width, const ImageBlock::PixelFormat &format ) {
+		if ( format.colorSpace_ == ImageBlock::ColorSpace_Linear )
+			return;
+		for ( uint32_t i = 0; i < width * 4; ++i ) {
+			if ( ( i & 3 ) != 3 )
+				rgba[ i ] = decodeColorSpace( rgba[ i ], format );
+		}
+	}
+
+	// _RGBARGBFԂŃGR[h
+	void ImageUtil::encodeColorSpaceRow( float *rgba, uint32_t width, const ImageBlock::PixelFormat &format ) {
+		if ( format.colorSpace_ == ImageBlock::ColorSpace_Linear )
+			return;
+		for ( uint32_t i = 0; i < width * 4; ++i ) {
+			if ( ( i & 3 ) != 3 )
+				rgba[ i ] = encodeColorSpace( rgba[ i ], format );
+		}
+	}
+
+	// x_Px
+	float ImageUtil::halfToFloat( uint16_t h ) {
+		const uint32_t sign = ( h & 0x8000 ) << 16;
+		uint32_t exp = ( h >> 10 ) & 0x1f;
+		uint32_t mant = h & 0x3ff;
+		uint32_t bits;
+		if ( exp == 0x1f ) {
+			// ANaN
+			bits = sign | 0x7f800000 | ( mant << 13 );
+		} else if ( exp != 0 ) {
+			bits = sign | ( ( exp + 112 ) << 23 ) | ( mant << 13 );
+		} else if ( mant == 0 ) {
+			bits = sign;
+		} else {
+			// 񐳋K𐳋K
+			exp = 113;
+			while ( ( mant & 0x400 ) == 0 ) {
+				mant <<= 1;
+				exp--;
+			}
+			bits = sign | ( exp << 23 ) | ( ( mant & 0x3ff ) << 13 );
+		}
+		float f;
+		memcpy( &f, &bits, sizeof( f ) );
+		return f;
+	}
+
+	// Px_甼x
+	//  ŋߐڋۂ߁B͈͊O͖
+	uint16_t ImageUtil::floatToHalf( float f ) {
+		uint32_t bits;
+		memcpy( &bits, &f, sizeof( bits ) );
+		const uint16_t sign = ( bits >> 16 ) & 0x8000;
+		const uint32_t exp = ( bits >> 23 ) & 0xff;
+		uint32_t mant = bits & 0x7fffff;
+		if ( exp == 0xff )
+			return sign | 0x7c00 | ( mant ? 0x200 : 0 );
+		const int32_t e = (int32_t)exp - 112;
+		if ( e >= 0x1f )
+			return sign | 0x7c00;
+		if ( e <= 0 ) {
+			// 񐳋K
+			if ( e < -10 )
+				return sign;
+			mant |= 0x800000;
+			const uint32_t shift = 14 - e;
+			uint32_t h = mant >> shift;
+			const uint32_t rem = mant & ( ( 1u << shift ) - 1 );
+			const uint32_t half = 1u << ( shift - 1 );
+			if ( rem > half || ( rem == half && ( h & 1 ) ) )
+				h++;
+			return sign | (uint16_t)h;
+		}
+		uint32_t h = ( e << 10 ) | ( mant >> 13 );
+		const uint32_t rem = mant & 0x1fff;
+		if ( rem > 0x1000 || ( rem == 0x1000 && ( h & 1 ) ) )
+			h++;	// JオŎwĂliőŖjɂȂ
+		return sign | (uint16_t)h;
+	}
+
 	// t@CRGBAC[W쐬
 	ImageBlock ImageUtil::createImageBlockFromFile( const char* filePath ) {
 		if ( filePath == 0 )
 			return ImageBlock();
 
 		int x, y, n;
+		if ( stbi_is_hdr( filePath ) ) {
+			float* data = stbi_loadf( filePath, &x, &y, &n, 0 );
+			if ( data == 0 )
+				return ImageBlock();
+			return ImageBlock( new ImageBlockBody( (unsigned char*)data, x, y, ImageBlock::PixelFormat( n, ImageBlock::ComponentType_F32, ImageBlock::ColorSpace_Linear ) ) );
+		}
+		if ( stbi_is_16_bit( filePath ) ) {
+			stbi_us* data = stbi_load_16( filePath, &x, &y, &n, 0 );
+			if ( data == 0 )
+				return ImageBlock();
+			return ImageBlock( new ImageBlockBody( (unsigned char*)data, x, y, ImageBlock::PixelFormat( n, ImageBlock::ComponentType_U16, ImageBlock::ColorSpace_Linear ) ) );
+		}
 		unsigned char* data = stbi_load( filePath, &x, &y, &n, 0 );
 		if ( data == 0 )
 			return ImageBlock();
-		return ImageBlock( new ImageBlockBody( data, x, y, n ) );
+		return ImageBlock( new ImageBlockBody( data, x, y, ImageBlock::PixelFormat( n, ImageBlock::ComponentType_U8, ImageBlock::ColorSpace_Linear ) ) );
+	}
+
+	// t@CkImageBlock쐬
+	ImageBlock ImageUtil::createImageBlockFromFile( const char* filePath, uint32_t scale, uint32_t *appliedScale ) {
+		if ( appliedScale )
+			*appliedScale = 1;
+		if ( filePath == 0 )
+			return ImageBlock();
+		if ( scale > 1 ) {
+			MappedFile file;
+			if ( file.open( filePath ) && JpegDecoder::isJpeg( file.data(), file.size() ) ) {
+				std::vector< uint8_t > data;
+				uint32_t w = 0, h = 0, n = 0;
+				if ( JpegDecoder::decode( file.data(), file.size(), scale, data, w, h, n ) ) {
+					if ( appliedScale )
+						*appliedScale = scale;
+					return ImageBlockCustom( w, h, ImageBlock::PixelFormat( n, ImageBlock::ComponentType_U8, ImageBlock::ColorSpace_Linear ), data.data() );
+				}
+			}
+		}
+		return createImageBlockFromFile( filePath );
+	}
+
+	// 摜t@C̃TCY擾
+	bool ImageUtil::getImageSize( const char* filePath, uint32_t &width, uint32_t &height ) {
+		int x, y, n;
+		if ( filePath == 0 || stbi_info( filePath, &x, &y, &n ) == 0 )
+			return false;
+		width = x;
+		height = y;
+		return true;
+	}
+
+	// eNZ̕ςŏkImageBlock쐬
+	ImageBlock ImageUtil::reduceImageBlock( const ImageBlock &block, uint32_t scale ) {
+		if ( block.isExist() == false || scale <= 1 )
+			return block;
+		const ImageBlock::PixelFormat &format = block.format();
+		RowDecoder decoder = getRowDecoder( format );
+		RowEncoder encoder = getRowEncoder( format );
+		if ( decoder == 0 || encoder == 0 )
+			return ImageBlock();
+
+		const uint32_t w = block.width();
+		const uint32_t h = block.height();
+		const uint32_t ow = ( w + scale - 1 ) / scale;
+		const uint32_t oh = ( h + scale - 1 ) / scale;
+		ImageBlockCustom out( ow, oh, format, 0 );
+		std::vector< float > row( w * 4 );
+		std::vector< float > sum( ow * 4 );
+		for ( uint32_t oy = 0; oy < oh; ++oy ) {
+			std::fill( sum.begin(), sum.end(), 0.0f );
+			const uint32_t y0 = oy * scale;
+			const uint32_t y1 = std::min( y0 + scale, h );
+			for ( uint32_t y = y0; y < y1; ++y ) {
+				decoder( block.row( y ), w, row.data() );
+				for ( uint32_t x = 0; x < w; ++x ) {
+					float *s = &sum[ ( x / scale ) * 4 ];
+					for ( int c = 0; c < 4; ++c )
+						s[ c ] += row[ x * 4 + c ];
+				}
+			}
+			for ( uint32_t ox = 0; ox < ow; ++ox ) {
+				const float inv = 1.0f / ( ( y1 - y0 ) * ( std::min( ox * scale + scale, w ) - ox * scale ) );
+				for ( int c = 0; c < 4; ++c )
+					sum[ ox * 4 + c ] *= inv;
+			}
+			encoder( sum.data(), ow, out.p() + (size_t)ow * format.bytePerColor() * oy );
+		}
+		return out;
+	}
+
+	// ̌^ϊImageBlock쐬
+	ImageBlock ImageUtil::convertImageBlock( const ImageBlock &block, ImageBlock::ComponentType type ) {
+		ImageBlock::PixelFormat format = block.format();
+		format.type_ = type;
+		return convertImageBlock( block, format );
+	}
+
+	// sNZtH[}bgϊImageBlock쐬
+	ImageBlock ImageUtil::convertImageBlock( const ImageBlock &block, const ImageBlock::PixelFormat &format ) {
+		const ImageBlock::PixelFormat &srcFormat = block.format();
+		if ( block.isExist() == false || ( srcFormat.type_ == format.type_ && srcFormat.channelNum_ == format.channelNum_ && block.pitch() == (uint64_t)block.width() * srcFormat.bytePerColor() ) )
+			return block;
+
+		RowDecoder decoder = getRowDecoder( srcFormat );
+		RowEncoder encoder = getRowEncoder( format );
+		if ( decoder == 0 || encoder == 0 )
+			return ImageBlock();
+
+		const uint32_t w = block.width();
+		ImageBlockCustom out( w, block.height(), format, 0 );
+		std::vector< float > row( w * 4 );
+		const uint8_t *src = block.p();
+		uint8_t *dest = out.p();
+		for ( uint32_t y = 0; y < block.height(); ++y ) {
+			decoder( src, w, row.data() );
+			encoder( row.data(), w, dest );
+			src += block.pitch();
+			dest += (size_t)w * format.bytePerColor();
+		}
+		return out;
 	}
 
 	// ImageBlock摜t@C
-	bool ImageUtil::createFileFromImageBlock( const ImageBlock &block, const char* filePath, int jpegQuarity ) {
+	bool ImageUtil::createFileFromImageBlock( const ImageBlock &block, const char* filePath, int jpegQuarity, uint32_t threadNum ) {
 		int res = 0;
 		std::string ext = OX::FileUtil::getExtName( filePath );
 		if ( ext == "" )
@@ -123,15 +846,106 @@ namespace OX {
 		std::transform( ext.begin(), ext.end(), ext.begin(),
 			[]( unsigned char c ) { return std::tolower( c ); } );
 
+		if ( ext == "hdr" ) {
+			ImageBlock fblock = convertImageBlock( block, ImageBlock::ComponentType_F32 );
+			return stbi_write_hdr( filePath, fblock.width(), fblock.height(), fblock.channelNum(), (const float*)fblock.p() ) != 0;
+		}
+
+		ImageBlock ublock = convertImageBlock( block, ImageBlock::ComponentType_U8 );
 		if ( ext == "bmp" ) {
-			res = stbi_write_bmp( filePath, block.width(), block.height(), block.bytePerColor(), block.p() );
+			res = stbi_write_bmp( filePath, ublock.width(), ublock.height(), ublock.channelNum(), ublock.p() );
 		} else if ( ext == "png" ) {
-			res = stbi_write_png( filePath, block.width(), block.height(), block.bytePerColor(), block.p(), 0 );
+			return createPNGFile( ublock, filePath, threadNum );
 		} else if ( ext == "jpg" ) {
-			res = stbi_write_jpg( filePath, block.width(), block.height(), block.bytePerColor(), block.p(), jpegQuarity );
+			res = stbi_write_jpg( filePath, ublock.width(), ublock.height(), ublock.channelNum(), ublock.p(), jpegQuarity );
 		} else if ( ext == "tga" ) {
-			res = stbi_write_tga( filePath, block.width(), block.height(), block.bytePerColor(), block.p() );
+			res = stbi_write_tga( filePath, ublock.width(), ublock.height(), ublock.channelNum(), ublock.p() );
 		}
 		return res != 0;
 	}
-}
\ No newline at end of file
+	// PNGt@CɃGR[hďo
+	bool ImageUtil::createPNGFile( const ImageBlock &block, const char *filePath, uint32_t threadNum, uint32_t stripRows ) {
+		ImageBlock ublock = convertImageBlock( block, ImageBlock::ComponentType_U8 );
+		const uint32_t width = ublock.width();
+		const uint32_t height = ublock.height();
+		const uint32_t bpp = ublock.channelNum();
+		if ( width == 0 || height == 0 || bpp < 1 || bpp > 4 )
+			return false;
+		const uint32_t rowBytes = width * bpp;
+		const uint64_t filteredPitch = (uint64_t)rowBytes + 1;
+		if ( stripRows == 0 )
+			stripRows = (uint32_t)std::max< uint64_t >( pngStripBytes_g / filteredPitch, 1 );
+		const uint32_t stripNum = ( height + stripRows - 1 ) / stripRows;
+		threadNum = resolveThreadNum( threadNum );
+
+		// s̃tB^
+		//  tB^͌̉摜̑O̍sQƂ̂ŁAтƗɏł
+		std::vector< uint8_t > filtered( filteredPitch * height );
+		parallelFor( stripNum, threadNum, [ & ]( uint64_t idx ) {
+			std::vector< uint8_t > work( (uint64_t)rowBytes * 5 );
+			const uint32_t y0 = (uint32_t)idx * stripRows;
+			const uint32_t y1 = std::min( y0 + stripRows, height );
+			for ( uint32_t y = y0; y < y1; ++y ) {
+				const uint8_t *row = ublock.p() + ublock.pitch() * y;
+				const uint8_t *prev = ( y > 0 ? row - ublock.pitch() : 0 );
+				filterPNGRow( row, prev, rowBytes, bpp, work.data(), &filtered[ filteredPitch * y ] );
+			}
+		} );
+
+		// іIDAT`NɈk
+		//  т̑O32KB̓tB^ς݂Ȃ̂ŎƂĎQƂłBŌ̃`NAdler-32tĂ
+		std::vector< std::vector< uint8_t > > chunks( stripNum );
+		parallelFor( stripNum, threadNum, [ & ]( uint64_t idx ) {
+			auto &chunk = chunks[ idx ];
+			const uint64_t begin = filteredPitch * idx * stripRows;
+			const uint64_t end = std::min< uint64_t >( filteredPitch * ( idx + 1 ) * stripRows, filtered.size() );
+			const uint32_t dictSize = (uint32_t)std::min< uint64_t >( begin, deflateWindow_g );
+			const bool isLast = ( idx + 1 == stripNum );
+			beginChunk( chunk, "IDAT" );
+			if ( idx == 0 ) {
+				chunk.push_back( 0x78 );	// deflateA32KB̑
+				chunk.push_back( 0x5e );
+			}
+			deflateStrip( &filtered[ begin ], end - begin, dictSize, isLast, chunk );
+			if ( isLast == false )
+				endChunk( chunk, 0 );
+		} );
+		pushU32BE( chunks.back(), adler32( filtered.data(), filtered.size() ) );
+		endChunk( chunks.back(), 0 );
+
+		// wb_ƃ`No
+		static const uint8_t colorTypes[] = { 0, 4, 2, 6 };	// O[AO[ƃAt@ARGBARGBA
+		std::vector< uint8_t > header = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+		beginChunk( header, "IHDR" );
+		pushU32BE( header, width );
+		pushU32BE( header, height );
+		header.push_back( 8 );	// rbg[x
+		header.push_back( colorTypes[ bpp - 1 ] );
+		header.push_back( 0 );	// k
+		header.push_back( 0 );	// tB^
+		header.push_back( 0 );	// C^[[X
+		endChunk( header, 8 );
+		std::vector< uint8_t > trailer;
+		beginChunk( trailer, "IEND" );
+		endChunk( trailer, 0 );
+
+		std::ofstream ofs( filePath, std::ios_base::out | std::ios_base::binary );
+		if ( !ofs )
+			return false;
+		ofs.write( (const char*)header.data(), header.size() );
+		for ( const auto &chunk : chunks )
+			ofs.write( (const char*)chunk.data(), chunk.size() );
+		ofs.write( (const char*)trailer.data(), trailer.size() );
+		return (bool)ofs;
+	}
+
+	// ImageBlockɉ摜t@C
+	bool ImageUtil::createFilesFromImageBlocks( const ImageBlock *blocks, const std::string *filePaths, uint32_t num, int jpegQuarity, uint32_t threadNum ) {
+		std::atomic< bool > res( true );
+		parallelFor( num, resolveThreadNum( threadNum ), [ & ]( uint64_t idx ) {
+			if ( createFileFromImageBlock( blocks[ idx ], filePaths[ idx ].c_str(), jpegQuarity, 1 ) == false )
+				res = false;
+		} );
+		return res;
+	}
+}
@@ -4,22 +4,64 @@
 // C[W[eBeB
 #include <stdint.h>
 #include <memory>
+#include <vector>
+#include <string>
+#include "oxmemory.h"
 
 namespace OX {
 	// C[WubN
 	// RGBÃubNێiQƁj
 	class ImageBlock {
 	public:
+		// ̌^
+		enum ComponentType {
+			ComponentType_U8,	// 8bit(0`255)
+			ComponentType_F32,	// 32bit_ijAHDRlj
+			ComponentType_U16,	// 16bit(0`65535)
+			ComponentType_F16,	// 16bit_ixj
+		};
+
+		// F
+		enum ColorSpace {
+			ColorSpace_Linear,	// jA
+			ColorSpace_SRGB,	// sRGB
+			ColorSpace_Gamma,	// wgamma_ׂ̂
+		};
+
+		// sNZtH[}bg
+		struct PixelFormat {
+			uint8_t channelNum_ = 0;						// `l(1`4)B1̓O[A2̓O[ƃAt@
+			ComponentType type_ = ComponentType_U8;		// ̌^
+			ColorSpace colorSpace_ = ColorSpace_Linear;	// Fԁil̉߂݂̂ŕῗȂj
+			float gamma_ = 2.2f;							// ColorSpace_Gamma̎w
+
+			PixelFormat() {}
+			PixelFormat( uint8_t channelNum, ComponentType type, ColorSpace colorSpace = ColorSpace_Linear ) : channelNum_( channelNum ), type_( type ), colorSpace_( colorSpace ) {}
+
+			// 1̃oCg擾
+			uint8_t bytePerComponent() const;
+
+			// 1J[̃oCg擾
+			uint8_t bytePerColor() const;
+		};
+
 		struct Body;
 		ImageBlock( Body *body = 0 );
 		virtual ~ImageBlock();
 
 		// ubNTCY擾
-		uint32_t size() const;
+		uint64_t size() const;
 
 		// ubN擾
 		uint8_t *p() const;
 
+		// 1s̃oCg擾
+		//  ImageBlockRefȊOwidth() * bytePerColor()
+		uint64_t pitch() const;
+
+		// ws̐擪AhX擾
+		uint8_t *row( uint32_t y ) const;
+
 		// C[WH
 		bool isExist() const;
 
@@ -30,6 +72,15 @@ namespace OX {
 		// 1J[̃oCg擾
 		uint8_t bytePerColor() const;
 
+		// 1J[̃`l擾
+		uint8_t channelNum() const;
+
+		// ̌^擾
+		ComponentType componentType() const;
+
+		// sNZtH[}bg擾
+		const PixelFormat &format() const;
+
 	protected:
 		std::shared_ptr< Body > body_;
 	};
@@ -38,9 +89,28 @@ namespace OX {
 	class ImageBlockCustom : public ImageBlock {
 	public:
 		ImageBlockCustom( uint32_t w, uint32_t h, uint32_t bytePerColor, uint8_t *data );
+
+		// ̌^w肵č쐬
+		//  data : w * h * channelNum̐B0̏ꍇ͖
+		ImageBlockCustom( uint32_t w, uint32_t h, uint32_t channelNum, ComponentType type, const void *data );
+
+		// sNZtH[}bgw肵č쐬
+		//  data      : w * h * format.bytePerColor()oCgB0̏ꍇ͖
+		//  allocator : mۂɎgAP[^BMemory::isLargȇ傫̏ꍇÃAP[^̓q[Wy[WŊmۂ
+		ImageBlockCustom( uint32_t w, uint32_t h, const PixelFormat &format, const void *data, const std::shared_ptr< Allocator > &allocator = Memory::getAllocator() );
 		virtual ~ImageBlockCustom();
 	};
 
+	// ĂяõQƂImageBlock
+	//  ȂBImageBlockRefiƂ̃Rs[jgI܂ŌĂяoŕێ
+	class ImageBlockRef : public ImageBlock {
+	public:
+		// data  : 擪AhX
+		// pitch : 1s̃oCgB0̏ꍇw * format.bytePerColor()
+		ImageBlockRef( uint32_t w, uint32_t h, const PixelFormat &format, const void *data, uint64_t pitch = 0 );
+		virtual ~ImageBlockRef();
+	};
+
 	// C[W
 	class ImageUtil {
 	public:
@@ -48,14 +118,92 @@ namespace OX {
 			BMP,
 			PNG,
 			JPEG,
-			TGA
+			TGA,
+			HDR
 		};
+		// s̕ϊ֐
+		//  RowDecoder : sNZtH[}bg̍s𕂓_RGBA(width * 4)ɕϊ
+		//  RowEncoder : _RGBA(width * 4)sNZtH[}bg̍sɕϊ
+		//  ^0`1ɐKBO[RGBɕAAt@ꍇ1Ƃ
+		typedef void ( *RowDecoder )( const uint8_t *src, uint32_t width, float *rgba );
+		typedef void ( *RowEncoder )( const float *rgba, uint32_t width, uint8_t *dest );
+
+		// sNZtH[}bgɑ΂s̕ϊ֐擾
+		//  tH[}bgɓꉻ֐Ԃ̂ŁAf[v̊OňxI
+		//  ΉĂȂtH[}bg̏ꍇ0
+		static RowDecoder getRowDecoder( const ImageBlock::PixelFormat &format );
+		static RowEncoder getRowEncoder( const ImageBlock::PixelFormat &format );
+
+		// FԂ̃e[ut̍s̕ϊ֐
+		//  ^̐llutňăjAlɕϊBAt@̓e[ugȂ
+		typedef void ( *RowDecoderLUT )( const uint8_t *src, uint32_t width, const float *lut, float *rgba );
+
+		// sNZtH[}bgɑ΂e[ut̍s̕ϊ֐擾
+		//  ^ȊO0
+		static RowDecoderLUT getRowDecoderLUT( const ImageBlock::PixelFormat &format );
+
+		// FԂ̃fR[he[u쐬
+		//  ^̐l烊jAlւ̃e[uiu8256Au1665536vfjB^ȊO͋
+		static std::vector< float > createDecodeTable( const ImageBlock::PixelFormat &format );
+
+		// FԂŃGR[hꂽl(0`1)ƃjAl̕ϊ
+		static float decodeColorSpace( float v, const ImageBlock::PixelFormat &format );
+		static float encodeColorSpace( float v, const ImageBlock::PixelFormat &format );
+
+		// _RGBA(width * 4)RGBFԂŕϊ
+		//  At@͂̂܂܁BjȀꍇ͉Ȃ
+		static void decodeColorSpaceRow( float *rgba, uint32_t width, const ImageBlock::PixelFormat &format );
+		static void encodeColorSpaceRow( float *rgba, uint32_t width, const ImageBlock::PixelFormat &format );
+
+		// x_Ƃ̕ϊ
+		static float halfToFloat( uint16_t h );
+		static uint16_t floatToHalf( float f );
+
 		// t@CImageBlock쐬
+		//  Radiance HDR(.hdr)32bit_A16bitPNG16bit̂܂ܓǂݍ
 		static ImageBlock createImageBlockFromFile( const char* filePath );
 
+		// t@CkImageBlock쐬
+		//  scale        : k(1, 2, 4, 8)
+		//  appliedScale : ۂ̏k
+		//  x[XCJPEGDCTW̒悾ŏk摜𒼐ڃfR[hi1/8DCŴ݁j
+		//  ȊǑ`▢ΉJPEG͓{œǂݍ݁AappliedScale1ɂȂ
+		static ImageBlock createImageBlockFromFile( const char* filePath, uint32_t scale, uint32_t *appliedScale );
+
+		// 摜t@C̃TCY擾
+		static bool getImageSize( const char* filePath, uint32_t &width, uint32_t &height );
+
+		// eNZ̕ςŏkImageBlock쐬
+		//  scale : kB[̒[͎c̃eNZŕς
+		static ImageBlock reduceImageBlock( const ImageBlock &block, uint32_t scale );
+
+		// ̌^ϊImageBlock쐬
+		//  _琮ւ0`1ɃNvBtH[}bgōsɌԂꍇ͂̂܂ܕԂ
+		static ImageBlock convertImageBlock( const ImageBlock &block, ImageBlock::ComponentType type );
+
+		// sNZtH[}bgϊImageBlock쐬
+		//  `lꍇ͌̃`l̂ĂBFԂ͕ϊȂ
+		//  s̊ԂɌԂiImageBlockRefjꍇ͓tH[}bgłl߂摜
+		static ImageBlock convertImageBlock( const ImageBlock &block, const ImageBlock::PixelFormat &format );
+
 		// ImageBlock摜t@C
 		//  jpegQuarity : JPEG̃NIeB[x(0-100)B̌`ł͖B
-		static bool createFileFromImageBlock( const ImageBlock &block, const char* filePath, int jpegQuarity = 100 );
+		//  threadNum   : PNG̈k̃XbhB0̏ꍇ̓n[hEFÃXbh
+		//  gqhdȑꍇ32bit_ŁAȊO8bitŏoBPNGcreatePNGFileŏo
+		static bool createFileFromImageBlock( const ImageBlock &block, const char* filePath, int jpegQuarity = 100, uint32_t threadNum = 0 );
+
+		// PNGt@CɃGR[hďo
+		//  sstripRowss̑тɕAs̃tB^deflatekіɃXbhōs
+		//  т̈k͑Ȏт̖32KBƂĎQƂAtbVŏIđіIDAT`NƂČq
+		//  threadNum : 0̏ꍇ̓n[hEFÃXbh
+		//  stripRows : 0̏ꍇ͑т256KBxɂȂs
+		//  8bitŏoBk͌Œnt}
+		static bool createPNGFile( const ImageBlock &block, const char *filePath, uint32_t threadNum = 0, uint32_t stripRows = 0 );
+
+		// ImageBlockɉ摜t@C
+		//  t@CɃXbhɊ蓖ĂiPNG̑т̕񉻂͍sȂjBL[u}bv̖ʖ̃t@CȂ
+		//  ߂l : 1łsꍇfalse
+		static bool createFilesFromImageBlocks( const ImageBlock *blocks, const std::string *filePaths, uint32_t num, int jpegQuarity = 100, uint32_t threadNum = 0 );
 	};
 }
 #endif
\ No newline at end of file
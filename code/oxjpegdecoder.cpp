@@ -0,0 +1,526 @@
+#include "oxjpegdecoder.h"
+#include <math.h>
+#include <string.h>
+
+namespace OX {
+	namespace {
+		// WOUOsD̈ʒuւ̕ϊ
+		const uint8_t dezigzag_g[ 64 ] = {
+			 0,  1,  8, 16,  9,  2,  3, 10,
+			17, 24, 32, 25, 18, 11,  4,  5,
+			12, 19, 26, 33, 40, 48, 41, 34,
+			27, 20, 13,  6,  7, 14, 21, 28,
+			35, 42, 49, 56, 57, 50, 43, 36,
+			29, 22, 15, 23, 30, 37, 44, 51,
+			58, 59, 52, 45, 38, 31, 39, 46,
+			53, 60, 61, 54, 47, 55, 62, 63,
+		};
+
+		// nt}e[u
+		//  fast_ : 擪fastBits_g bitňe[uB8biti0͒jA8bitl
+		static const uint32_t fastBits_g = 9;
+		struct HuffmanTable {
+			uint16_t fast_[ 1 << fastBits_g ];
+			int32_t maxCode_[ 18 ];		// ̍ő̕iꍇ-1j
+			int32_t valPtr_[ 17 ];		// ̍ŏ̒l̃CfbNX - ŏ̕
+			uint8_t values_[ 256 ];
+			bool isExist_ = false;
+
+			// e[u\z
+			//  ̐l̐╄ŕ\鐔𒴂ꍇ́Ae[u𖄂߂OɎs
+			bool build( const uint8_t *counts, const uint8_t *values, uint32_t valueNum ) {
+				uint32_t total = 0;
+				for ( int32_t len = 1; len <= 16; ++len )
+					total += counts[ len - 1 ];
+				if ( valueNum > 256 || total > valueNum )
+					return false;
+				memset( fast_, 0, sizeof( fast_ ) );
+				memcpy( values_, values, valueNum );
+				int32_t code = 0, k = 0;
+				for ( int32_t len = 1; len <= 16; ++len ) {
+					if ( code + counts[ len - 1 ] > ( 1 << len ) )
+						return false;
+					valPtr_[ len ] = k - code;
+					for ( uint32_t i = 0; i < counts[ len - 1 ]; ++i, ++k, ++code ) {
+						if ( len <= (int32_t)fastBits_g ) {
+							const int32_t shift = fastBits_g - len;
+							for ( int32_t j = 0; j < ( 1 << shift ); ++j )
+								fast_[ ( code << shift ) | j ] = (uint16_t)( ( len << 8 ) | values_[ k ] );
+						}
+					}
+					maxCode_[ len ] = ( counts[ len - 1 ] ? code - 1 : -1 );
+					code <<= 1;
+				}
+				maxCode_[ 17 ] = 0x7fffffff;
+				isExist_ = true;
+				return true;
+			}
+		};
+
+		// Ggs[ꂽf[^̃rbgǂݍ
+		//  0xFF00̓X^btBOƂ0xFFɁA}[J[ɒB0
+		class BitReader {
+		public:
+			BitReader( const uint8_t *p, const uint8_t *end ) : p_( p ), end_( end ) {}
+
+			void fill() {
+				while ( bitNum_ <= 24 ) {
+					uint32_t b = 0;
+					if ( isMarker_ == false && p_ < end_ ) {
+						b = *p_;
+						if ( b == 0xFF ) {
+							const uint8_t next = ( p_ + 1 < end_ ? p_[ 1 ] : 0 );
+							if ( next == 0x00 ) {
+								p_ += 2;
+							} else {
+								isMarker_ = true;
+								b = 0;
+							}
+						} else {
+							++p_;
+						}
+					}
+					bits_ |= b << ( 24 - bitNum_ );
+					bitNum_ += 8;
+				}
+			}
+
+			uint32_t peek( uint32_t num ) {
+				fill();
+				return bits_ >> ( 32 - num );
+			}
+
+			void skip( uint32_t num ) {
+				if ( bitNum_ < (int32_t)num )
+					fill();
+				bits_ <<= num;
+				bitNum_ -= num;
+			}
+
+			// t̒ǉrbgǂݍ
+			int32_t receiveExtend( uint32_t num ) {
+				if ( num == 0 )
+					return 0;
+				const int32_t v = (int32_t)peek( num );
+				skip( num );
+				return ( v < ( 1 << ( num - 1 ) ) ? v - ( 1 << num ) + 1 : v );
+			}
+
+			// nt}1ǂݍ
+			//  ߂l : sȕ̏ꍇ-1
+			int32_t decode( const HuffmanTable &table ) {
+				const uint32_t fast = table.fast_[ peek( fastBits_g ) ];
+				if ( fast >> 8 ) {
+					skip( fast >> 8 );
+					return fast & 0xFF;
+				}
+				const uint32_t bits = peek( 16 );
+				for ( uint32_t len = fastBits_g + 1; len <= 16; ++len ) {
+					const int32_t code = (int32_t)( bits >> ( 16 - len ) );
+					if ( code <= table.maxCode_[ len ] ) {
+						skip( len );
+						return table.values_[ table.valPtr_[ len ] + code ];
+					}
+				}
+				return -1;
+			}
+
+			// X^[g}[J[̌ォĊJ
+			void restart() {
+				bits_ = 0;
+				bitNum_ = 0;
+				isMarker_ = false;
+				while ( p_ + 1 < end_ && !( p_[ 0 ] == 0xFF && p_[ 1 ] >= 0xD0 && p_[ 1 ] <= 0xD7 ) )
+					++p_;
+				if ( p_ + 1 < end_ )
+					p_ += 2;
+			}
+
+			const uint8_t *position() const { return p_; }
+
+		private:
+			const uint8_t *p_;
+			const uint8_t *end_;
+			uint32_t bits_ = 0;
+			int32_t bitNum_ = 0;
+			bool isMarker_ = false;
+		};
+
+		// 
+		struct Component {
+			uint32_t id_ = 0;
+			uint32_t h_ = 1, v_ = 1;		// TvOW
+			uint32_t quant_ = 0;			// ʎqe[uԍ
+			uint32_t dcTable_ = 0, acTable_ = 0;
+			int32_t dcPred_ = 0;
+			uint32_t blockW_ = 0, blockH_ = 0;	// MCUɍ킹ubN
+			uint32_t planeW_ = 0;			// k̖ʂ̕iblockW_ * nj
+			std::vector< uint8_t > plane_;	// k̖
+		};
+
+		uint32_t read16( const uint8_t *p ) {
+			return ( (uint32_t)p[ 0 ] << 8 ) | p[ 1 ];
+		}
+
+		uint8_t clampU8( float v ) {
+			return (uint8_t)( v <= 0.0f ? 0 : v >= 255.0f ? 255 : (int32_t)( v + 0.5f ) );
+		}
+
+		// JPEG̃fR[_{
+		class Decoder {
+		public:
+			Decoder( const uint8_t *data, uint64_t size, uint32_t n ) : p_( data ), end_( data + size ), n_( n ) {
+				// kIDCŤW : 0.5 * C(u) * cos( ( 2x + 1 )u / 2n )
+				for ( uint32_t x = 0; x < n_; ++x ) {
+					for ( uint32_t u = 0; u < n_; ++u ) {
+						const double c = ( u == 0 ? sqrt( 0.5 ) : 1.0 );
+						idct_[ x * n_ + u ] = (float)( 0.5 * c * cos( ( 2.0 * x + 1.0 ) * u * 3.14159265358979323846 / ( 2.0 * n_ ) ) );
+					}
+				}
+			}
+
+			bool decode() {
+				if ( end_ - p_ < 2 || read16( p_ ) != 0xFFD8 )
+					return false;
+				p_ += 2;
+				while ( p_ + 4 <= end_ ) {
+					if ( p_[ 0 ] != 0xFF ) {
+						++p_;
+						continue;
+					}
+					const uint32_t marker = p_[ 1 ];
+					if ( marker == 0xFF ) {
+						// tBoCgB0xFF}[J[̐擪ɂȂ蓾̂1oCgi߂
+						++p_;
+						continue;
+					}
+					p_ += 2;
+					if ( ( marker >= 0xD0 && marker <= 0xD7 ) || marker == 0x01 )
+						continue;
+					if ( marker == 0xD9 )
+						break;
+					const uint32_t len = read16( p_ );
+					if ( len < 2 || p_ + len > end_ )
+						return false;
+					const uint8_t *seg = p_ + 2;
+					const uint32_t segLen = len - 2;
+					p_ += len;
+					bool ok = true;
+					switch ( marker ) {
+					case 0xC0:
+					case 0xC1:
+						ok = parseSOF( seg, segLen );
+						break;
+					case 0xC4:
+						ok = parseDHT( seg, segLen );
+						break;
+					case 0xDB:
+						ok = parseDQT( seg, segLen );
+						break;
+					case 0xDD:
+						ok = ( segLen >= 2 );
+						if ( ok )
+							restartInterval_ = read16( seg );
+						break;
+					case 0xEE:
+						if ( segLen >= 12 && memcmp( seg, "Adobe", 5 ) == 0 )
+							adobeTransform_ = seg[ 11 ];
+						break;
+					case 0xDA:
+						ok = ( frame_ && parseSOS( seg, segLen ) );
+						break;
+					default:
+						// SOF2ȍ~ivObVuAZpȂǁj͖Ή
+						if ( marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC )
+							return false;
+						break;
+					}
+					if ( ok == false )
+						return false;
+				}
+				return frame_ && scanNum_ > 0;
+			}
+
+			// RGB̓O[̉摜o
+			void output( std::vector< uint8_t > &out, uint32_t &width, uint32_t &height, uint32_t &channelNum ) const {
+				const uint32_t scale = 8 / n_;
+				width = ( width_ + scale - 1 ) / scale;
+				height = ( height_ + scale - 1 ) / scale;
+				channelNum = ( components_.size() == 1 ? 1 : 3 );
+				out.resize( (size_t)width * height * channelNum );
+				const bool isRGB = ( adobeTransform_ == 0 || ( components_.size() == 3 && components_[ 0 ].id_ == 'R' && components_[ 1 ].id_ == 'G' && components_[ 2 ].id_ == 'B' ) );
+				uint8_t *dest = out.data();
+				for ( uint32_t y = 0; y < height; ++y ) {
+					if ( channelNum == 1 ) {
+						const Component &c = components_[ 0 ];
+						memcpy( dest, &c.plane_[ (size_t)y * c.planeW_ ], width );
+						dest += width;
+						continue;
+					}
+					// TuTvOꂽ͍ŋߖTŊg
+					const uint8_t *rows[ 3 ];
+					for ( int i = 0; i < 3; ++i ) {
+						const Component &c = components_[ i ];
+						rows[ i ] = &c.plane_[ (size_t)( y * c.v_ / maxV_ ) * c.planeW_ ];
+					}
+					for ( uint32_t x = 0; x < width; ++x, dest += 3 ) {
+						const float c0 = rows[ 0 ][ x * components_[ 0 ].h_ / maxH_ ];
+						const float c1 = rows[ 1 ][ x * components_[ 1 ].h_ / maxH_ ];
+						const float c2 = rows[ 2 ][ x * components_[ 2 ].h_ / maxH_ ];
+						if ( isRGB ) {
+							dest[ 0 ] = (uint8_t)c0;
+							dest[ 1 ] = (uint8_t)c1;
+							dest[ 2 ] = (uint8_t)c2;
+						} else {
+							dest[ 0 ] = clampU8( c0 + 1.402f * ( c2 - 128.0f ) );
+							dest[ 1 ] = clampU8( c0 - 0.344136f * ( c1 - 128.0f ) - 0.714136f * ( c2 - 128.0f ) );
+							dest[ 2 ] = clampU8( c0 + 1.772f * ( c1 - 128.0f ) );
+						}
+					}
+				}
+			}
+
+		private:
+			bool parseSOF( const uint8_t *seg, uint32_t len ) {
+				if ( len < 6 || seg[ 0 ] != 8 )
+					return false;
+				height_ = read16( seg + 1 );
+				width_ = read16( seg + 3 );
+				const uint32_t num = seg[ 5 ];
+				if ( width_ == 0 || height_ == 0 || ( num != 1 && num != 3 ) || len < 6 + num * 3 )
+					return false;
+				components_.resize( num );
+				for ( uint32_t i = 0; i < num; ++i ) {
+					Component &c = components_[ i ];
+					c.id_ = seg[ 6 + i * 3 ];
+					c.h_ = seg[ 7 + i * 3 ] >> 4;
+					c.v_ = seg[ 7 + i * 3 ] & 15;
+					c.quant_ = seg[ 8 + i * 3 ];
+					if ( c.h_ == 0 || c.h_ > 4 || c.v_ == 0 || c.v_ > 4 || c.quant_ > 3 )
+						return false;
+					maxH_ = ( c.h_ > maxH_ ? c.h_ : maxH_ );
+					maxV_ = ( c.v_ > maxV_ ? c.v_ : maxV_ );
+				}
+				mcuW_ = ( width_ + maxH_ * 8 - 1 ) / ( maxH_ * 8 );
+				mcuH_ = ( height_ + maxV_ * 8 - 1 ) / ( maxV_ * 8 );
+				for ( auto &c : components_ ) {
+					c.blockW_ = mcuW_ * c.h_;
+					c.blockH_ = mcuH_ * c.v_;
+					c.planeW_ = c.blockW_ * n_;
+					c.plane_.assign( (size_t)c.planeW_ * c.blockH_ * n_, 0 );
+				}
+				frame_ = true;
+				return true;
+			}
+
+			bool parseDHT( const uint8_t *seg, uint32_t len ) {
+				while ( len >= 17 ) {
+					const uint32_t cls = seg[ 0 ] >> 4;
+					const uint32_t id = seg[ 0 ] & 15;
+					uint32_t total = 0;
+					for ( int i = 0; i < 16; ++i )
+						total += seg[ 1 + i ];
+					if ( cls > 1 || id > 3 || total > 256 || len < 17 + total )
+						return false;
+					if ( ( cls == 0 ? dcTables_[ id ] : acTables_[ id ] ).build( seg + 1, seg + 17, total ) == false )
+						return false;
+					seg += 17 + total;
+					len -= 17 + total;
+				}
+				return true;
+			}
+
+			bool parseDQT( const uint8_t *seg, uint32_t len ) {
+				while ( len >= 1 ) {
+					const uint32_t precision = seg[ 0 ] >> 4;
+					const uint32_t id = seg[ 0 ] & 15;
+					const uint32_t size = ( precision ? 129 : 65 );
+					if ( id > 3 || len < size )
+						return false;
+					for ( int i = 0; i < 64; ++i )
+						quant_[ id ][ i ] = ( precision ? read16( seg + 1 + i * 2 ) : seg[ 1 + i ] );
+					seg += size;
+					len -= size;
+				}
+				return true;
+			}
+
+			bool parseSOS( const uint8_t *seg, uint32_t len ) {
+				const uint32_t num = ( len > 0 ? seg[ 0 ] : 0 );
+				if ( num == 0 || num > 4 || len < 4 + num * 2 )
+					return false;
+				// x[XC͑SW1̃XLő̂ŁASs=0, Se=63, Ah=Al=0̂
+				const uint8_t *sp = seg + 1 + num * 2;
+				if ( sp[ 0 ] != 0 || sp[ 1 ] != 63 || sp[ 2 ] != 0 )
+					return false;
+				Component *scan[ 4 ];
+				for ( uint32_t i = 0; i < num; ++i ) {
+					scan[ i ] = 0;
+					for ( auto &c : components_ ) {
+						if ( c.id_ == seg[ 1 + i * 2 ] )
+							scan[ i ] = &c;
+					}
+					if ( scan[ i ] == 0 )
+						return false;
+					scan[ i ]->dcTable_ = seg[ 2 + i * 2 ] >> 4;
+					scan[ i ]->acTable_ = seg[ 2 + i * 2 ] & 15;
+					if ( scan[ i ]->dcTable_ > 3 || scan[ i ]->acTable_ > 3 ||
+						dcTables_[ scan[ i ]->dcTable_ ].isExist_ == false || acTables_[ scan[ i ]->acTable_ ].isExist_ == false )
+						return false;
+					scan[ i ]->dcPred_ = 0;
+				}
+				BitReader reader( p_, end_ );
+				bool ok = ( num == 1 ? decodeSingleScan( reader, *scan[ 0 ] ) : decodeInterleavedScan( reader, scan, num ) );
+				p_ = reader.position();
+				++scanNum_;
+				return ok;
+			}
+
+			// 1̃XLiMCU1ubNA摜̃ubN̂݁j
+			bool decodeSingleScan( BitReader &reader, Component &c ) {
+				const uint32_t bw = ( ( width_ * c.h_ + maxH_ - 1 ) / maxH_ + 7 ) / 8;
+				const uint32_t bh = ( ( height_ * c.v_ + maxV_ - 1 ) / maxV_ + 7 ) / 8;
+				uint32_t count = 0;
+				for ( uint32_t by = 0; by < bh; ++by ) {
+					for ( uint32_t bx = 0; bx < bw; ++bx ) {
+						checkRestart( reader, count );
+						if ( decodeBlock( reader, c, bx, by ) == false )
+							return false;
+					}
+				}
+				return true;
+			}
+
+			// ̃C^[[uꂽXL
+			bool decodeInterleavedScan( BitReader &reader, Component **scan, uint32_t num ) {
+				uint32_t count = 0;
+				for ( uint32_t my = 0; my < mcuH_; ++my ) {
+					for ( uint32_t mx = 0; mx < mcuW_; ++mx ) {
+						checkRestart( reader, count );
+						for ( uint32_t i = 0; i < num; ++i ) {
+							Component &c = *scan[ i ];
+							for ( uint32_t y = 0; y < c.v_; ++y ) {
+								for ( uint32_t x = 0; x < c.h_; ++x ) {
+									if ( decodeBlock( reader, c, mx * c.h_ + x, my * c.v_ + y ) == false )
+										return false;
+								}
+							}
+						}
+					}
+				}
+				return true;
+			}
+
+			// X^[gԊuɗ\lZbg
+			void checkRestart( BitReader &reader, uint32_t &count ) {
+				if ( restartInterval_ > 0 && count == restartInterval_ ) {
+					reader.restart();
+					for ( auto &c : components_ )
+						c.dcPred_ = 0;
+					count = 0;
+				}
+				++count;
+			}
+
+			// 1ubNfR[hďkʂɏ
+			//  ACW͏kɎgn x n͈̔͂̂ݕێAc͓ǂݔ΂
+			bool decodeBlock( BitReader &reader, Component &c, uint32_t bx, uint32_t by ) {
+				const uint16_t *q = quant_[ c.quant_ ];
+				const int32_t t = reader.decode( dcTables_[ c.dcTable_ ] );
+				if ( t < 0 || t > 16 )
+					return false;
+				c.dcPred_ += reader.receiveExtend( t );
+				float coef[ 64 ];
+				coef[ 0 ] = (float)( c.dcPred_ * (int32_t)q[ 0 ] );
+				const bool hasAC = ( n_ > 1 );
+				if ( hasAC )
+					memset( coef + 1, 0, sizeof( float ) * 63 );
+				const HuffmanTable &ac = acTables_[ c.acTable_ ];
+				for ( uint32_t k = 1; k < 64; ) {
+					const int32_t rs = reader.decode( ac );
+					if ( rs < 0 )
+						return false;
+					const uint32_t run = rs >> 4;
+					const uint32_t size = rs & 15;
+					if ( size == 0 ) {
+						if ( run != 15 )
+							break;	// EOB
+						k += 16;
+						continue;
+					}
+					k += run;
+					if ( k > 63 )
+						return false;
+					if ( hasAC ) {
+						const uint32_t pos = dezigzag_g[ k ];
+						if ( ( pos & 7 ) < n_ && ( pos >> 3 ) < n_ ) {
+							coef[ pos ] = (float)( reader.receiveExtend( size ) * (int32_t)q[ k ] );
+						} else {
+							reader.skip( size );
+						}
+					} else {
+						reader.skip( size );
+					}
+					++k;
+				}
+
+				// kIDCTin = 1DCW / 8ubNρj
+				uint8_t *dest = &c.plane_[ ( (size_t)by * n_ ) * c.planeW_ + bx * n_ ];
+				if ( hasAC == false ) {
+					dest[ 0 ] = clampU8( coef[ 0 ] * 0.125f + 128.0f );
+					return true;
+				}
+				float tmp[ 64 ];
+				for ( uint32_t v = 0; v < n_; ++v ) {
+					for ( uint32_t x = 0; x < n_; ++x ) {
+						float s = 0.0f;
+						for ( uint32_t u = 0; u < n_; ++u )
+							s += idct_[ x * n_ + u ] * coef[ v * 8 + u ];
+						tmp[ v * 8 + x ] = s;
+					}
+				}
+				for ( uint32_t y = 0; y < n_; ++y, dest += c.planeW_ ) {
+					for ( uint32_t x = 0; x < n_; ++x ) {
+						float s = 0.0f;
+						for ( uint32_t v = 0; v < n_; ++v )
+							s += idct_[ y * n_ + v ] * tmp[ v * 8 + x ];
+						dest[ x ] = clampU8( s + 128.0f );
+					}
+				}
+				return true;
+			}
+
+			const uint8_t *p_;
+			const uint8_t *end_;
+			uint32_t n_;	// ubN̏o̓eNZiӁj
+			float idct_[ 64 ];
+			HuffmanTable dcTables_[ 4 ];
+			HuffmanTable acTables_[ 4 ];
+			uint16_t quant_[ 4 ][ 64 ] = {};	// WOUO
+			std::vector< Component > components_;
+			uint32_t width_ = 0, height_ = 0;
+			uint32_t maxH_ = 1, maxV_ = 1;
+			uint32_t mcuW_ = 0, mcuH_ = 0;
+			uint32_t restartInterval_ = 0;
+			int32_t adobeTransform_ = -1;
+			bool frame_ = false;
+			uint32_t scanNum_ = 0;
+		};
+	}
+
+	// JPEG̃f[^H
+	bool JpegDecoder::isJpeg( const uint8_t *data, uint64_t size ) {
+		return ( data != 0 && size >= 3 && data[ 0 ] == 0xFF && data[ 1 ] == 0xD8 && data[ 2 ] == 0xFF );
+	}
+
+	// kăfR[h
+	bool JpegDecoder::decode( const uint8_t *data, uint64_t size, uint32_t scale, std::vector< uint8_t > &out, uint32_t &width, uint32_t &height, uint32_t &channelNum ) {
+		if ( isJpeg( data, size ) == false || ( scale != 1 && scale != 2 && scale != 4 && scale != 8 ) )
+			return false;
+		Decoder decoder( data, size, 8 / scale );
+		if ( decoder.decode() == false )
+			return false;
+		decoder.output( out, width, height, channelNum );
+		return true;
+	}
+}
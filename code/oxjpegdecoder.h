@@ -0,0 +1,28 @@
+#ifndef __ox_oxjpegdecoder_h__
+#define __ox_oxjpegdecoder_h__
+
+// JPEG̏kfR[h
+
+#include <stdint.h>
+#include <vector>
+
+namespace OX {
+	// JPEG̏kfR[_
+	//  8x8ubNDCTŴ悾gA1/2A1/4A1/8̉摜𒼐ڍ
+	//  1/8DCWiubNρĵ݂IDCTsȂB1/2A1/4͒̌W̏kIDCTs
+	//  x[XCint}A8bitĵݑΉBvObVuAZpA12bit͖Ή
+	class JpegDecoder {
+	public:
+		// JPEG̃f[^H
+		static bool isJpeg( const uint8_t *data, uint64_t size );
+
+		// kăfR[h
+		//  scale      : k(1, 2, 4, 8)B1̏ꍇ͓{IDCTs
+		//  out        : width * height * channelNumu8̏o͐
+		//  channelNum : 1iO[j3iRGBj
+		//  ߂l     : Ή̌`ꂽf[^̏ꍇfalse
+		static bool decode( const uint8_t *data, uint64_t size, uint32_t scale, std::vector< uint8_t > &out, uint32_t &width, uint32_t &height, uint32_t &channelNum );
+	};
+}
+
+#endif
@@ -0,0 +1,271 @@
+#include "oxmemory.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#include <stdlib.h>
+#endif
+
+namespace OX {
+	namespace {
+		static const uint64_t hugePageSize_g = 2ull * 1024 * 1024;	// 2MB
+		uint64_t largeThreshold_g = 32ull * 1024 * 1024;
+		std::shared_ptr< Allocator > allocator_g;
+		std::shared_ptr< Allocator > defaultAllocator_g = std::make_shared< DefaultAllocator >();
+
+		uint64_t roundUp( uint64_t v, uint64_t align ) {
+			return ( v + align - 1 ) / align * align;
+		}
+
+#ifdef _WIN32
+		// SeLockMemoryPrivilegeLɂł烉[Wy[W̃TCYAłȂ0
+		SIZE_T getLargePageSize() {
+			static SIZE_T size = []() -> SIZE_T {
+				HANDLE token = 0;
+				if ( OpenProcessToken( GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token ) == FALSE )
+					return 0;
+				TOKEN_PRIVILEGES tp = {};
+				tp.PrivilegeCount = 1;
+				tp.Privileges[ 0 ].Attributes = SE_PRIVILEGE_ENABLED;
+				BOOL ok = LookupPrivilegeValueA( 0, "SeLockMemoryPrivilege", &tp.Privileges[ 0 ].Luid );
+				if ( ok )
+					ok = AdjustTokenPrivileges( token, FALSE, &tp, 0, 0, 0 ) && GetLastError() == ERROR_SUCCESS;
+				CloseHandle( token );
+				return ( ok ? GetLargePageMinimum() : 0 );
+			}();
+			return size;
+		}
+#endif
+	}
+
+	// 傫ȗ̈̊m
+	void *Memory::allocateLarge( uint64_t size ) {
+		if ( size == 0 )
+			return 0;
+#ifdef _WIN32
+		const SIZE_T largePage = getLargePageSize();
+		if ( largePage > 0 ) {
+			void *p = VirtualAlloc( 0, (SIZE_T)roundUp( size, largePage ), MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+			if ( p )
+				return p;
+		}
+		return VirtualAlloc( 0, (SIZE_T)size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+#else
+		void *p = mmap( 0, (size_t)roundUp( size, hugePageSize_g ), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+		if ( p == MAP_FAILED )
+			return 0;
+#ifdef MADV_HUGEPAGE
+		madvise( p, (size_t)roundUp( size, hugePageSize_g ), MADV_HUGEPAGE );
+#endif
+		return p;
+#endif
+	}
+
+	// allocateLargeŊmۂ̈̉
+	void Memory::freeLarge( void *p, uint64_t size ) {
+		if ( p == 0 )
+			return;
+#ifdef _WIN32
+		VirtualFree( p, 0, MEM_RELEASE );
+#else
+		munmap( p, (size_t)roundUp( size, hugePageSize_g ) );
+#endif
+	}
+
+	// ̗̈Ƀq[Wy[W𐄏
+	void Memory::adviseHugePage( void *p, uint64_t size ) {
+#if !defined( _WIN32 ) && defined( MADV_HUGEPAGE )
+		if ( p == 0 )
+			return;
+		const uint64_t begin = roundUp( (uint64_t)(uintptr_t)p, hugePageSize_g );
+		const uint64_t end = ( (uint64_t)(uintptr_t)p + size ) / hugePageSize_g * hugePageSize_g;
+		if ( begin < end )
+			madvise( (void*)(uintptr_t)begin, (size_t)( end - begin ), MADV_HUGEPAGE );
+#endif
+	}
+
+	// allocateLargeg臒lݒ
+	void Memory::setLargeThreshold( uint64_t size ) {
+		largeThreshold_g = size;
+	}
+
+	// allocateLargeg臒l擾
+	uint64_t Memory::getLargeThreshold() {
+		return largeThreshold_g;
+	}
+
+	// allocateLargeg傫H
+	bool Memory::isLarge( uint64_t size ) {
+		return largeThreshold_g > 0 && size >= largeThreshold_g;
+	}
+
+	// 摜ƍƗ̈ɎgAP[^ݒ
+	void Memory::setAllocator( const std::shared_ptr< Allocator > &allocator ) {
+		allocator_g = allocator;
+	}
+
+	// 摜ƍƗ̈ɎgAP[^擾
+	const std::shared_ptr< Allocator > &Memory::getAllocator() {
+		return ( allocator_g ? allocator_g : defaultAllocator_g );
+	}
+
+	// ̃AP[^̊m
+	//  擪alignment_goCgɊmە@L^ǍԂ
+	void *DefaultAllocator::allocate( uint64_t size ) {
+		if ( size == 0 )
+			return 0;
+		const uint64_t total = size + alignment_g;
+		uint8_t *p = 0;
+		uint64_t isLarge = 0;
+		if ( Memory::isLarge( total ) ) {
+			p = (uint8_t*)Memory::allocateLarge( total );
+			isLarge = ( p != 0 );
+		}
+		if ( p == 0 ) {
+#ifdef _WIN32
+			p = (uint8_t*)_aligned_malloc( (size_t)total, (size_t)alignment_g );
+#else
+			void *m = 0;
+			p = ( posix_memalign( &m, (size_t)alignment_g, (size_t)total ) == 0 ? (uint8_t*)m : 0 );
+#endif
+			if ( p == 0 )
+				return 0;
+		}
+		*(uint64_t*)p = isLarge;
+		return p + alignment_g;
+	}
+
+	// ̃AP[^̉
+	void DefaultAllocator::deallocate( void *p, uint64_t size ) {
+		if ( p == 0 )
+			return;
+		uint8_t *head = (uint8_t*)p - alignment_g;
+		if ( *(uint64_t*)head ) {
+			Memory::freeLarge( head, size + alignment_g );
+			return;
+		}
+#ifdef _WIN32
+		_aligned_free( head );
+#else
+		free( head );
+#endif
+	}
+
+	PoolAllocator::PoolAllocator( uint64_t maxPooledBytes ) : maxPooledBytes_( maxPooledBytes ) {
+	}
+
+	PoolAllocator::~PoolAllocator() {
+		trim();
+	}
+
+	// TCYNX̔ԍ擾
+	//  alignment_gȉ0Bȍ~2^bit < size <= 2^(bit+1)4NX
+	uint32_t PoolAllocator::getClassIndex( uint64_t size ) {
+		if ( size <= alignment_g )
+			return 0;
+		uint32_t bit = 63;
+		while ( ( ( size - 1 ) >> bit ) == 0 )
+			--bit;
+		const uint32_t sub = (uint32_t)( ( ( size - 1 ) >> ( bit - 2 ) ) & 3 );
+		return ( bit - 5 ) * 4 + sub - 3;
+	}
+
+	// TCYNX̔ԍ傫擾
+	uint64_t PoolAllocator::getClassSizeByIndex( uint32_t index ) {
+		if ( index == 0 )
+			return alignment_g;
+		const uint32_t bit = ( index + 3 ) / 4 + 5;
+		const uint32_t sub = ( index + 3 ) % 4;
+		return (uint64_t)( 5 + sub ) << ( bit - 2 );
+	}
+
+	// TCYNX̑傫擾
+	uint64_t PoolAllocator::getClassSize( uint64_t size ) {
+		return getClassSizeByIndex( getClassIndex( size ) );
+	}
+
+	// m
+	void *PoolAllocator::allocate( uint64_t size ) {
+		if ( size == 0 )
+			return 0;
+		const uint32_t index = getClassIndex( size );
+		const uint64_t classSize = getClassSize( size );
+		{
+			std::lock_guard< std::mutex > lock( mutex_ );
+			stat_.allocateNum_++;
+			if ( index < pools_.size() && pools_[ index ].empty() == false ) {
+				void *p = pools_[ index ].back();
+				pools_[ index ].pop_back();
+				stat_.poolHitNum_++;
+				stat_.pooledBytes_ -= classSize;
+				stat_.usedBytes_ += classSize;
+				return p;
+			}
+		}
+		void *p = system_.allocate( classSize );
+		if ( p == 0 )
+			return 0;
+		std::lock_guard< std::mutex > lock( mutex_ );
+		stat_.systemAllocateNum_++;
+		stat_.usedBytes_ += classSize;
+		if ( stat_.usedBytes_ + stat_.pooledBytes_ > stat_.peakBytes_ )
+			stat_.peakBytes_ = stat_.usedBytes_ + stat_.pooledBytes_;
+		return p;
+	}
+
+	// 
+	void PoolAllocator::deallocate( void *p, uint64_t size ) {
+		if ( p == 0 )
+			return;
+		const uint32_t index = getClassIndex( size );
+		const uint64_t classSize = getClassSize( size );
+		{
+			std::lock_guard< std::mutex > lock( mutex_ );
+			stat_.deallocateNum_++;
+			stat_.usedBytes_ -= classSize;
+			if ( maxPooledBytes_ == 0 || stat_.pooledBytes_ + classSize <= maxPooledBytes_ ) {
+				if ( index >= pools_.size() )
+					pools_.resize( index + 1 );
+				pools_[ index ].push_back( p );
+				stat_.pooledBytes_ += classSize;
+				return;
+			}
+			stat_.systemFreeNum_++;
+		}
+		system_.deallocate( p, classSize );
+	}
+
+	// v[̗̈SăVXeɕԂ
+	void PoolAllocator::trim() {
+		std::lock_guard< std::mutex > lock( mutex_ );
+		for ( uint32_t i = 0; i < pools_.size(); ++i ) {
+			if ( pools_[ i ].empty() )
+				continue;
+			const uint64_t classSize = getClassSizeByIndex( i );
+			for ( void *p : pools_[ i ] ) {
+				system_.deallocate( p, classSize );
+				stat_.systemFreeNum_++;
+				stat_.pooledBytes_ -= classSize;
+			}
+			pools_[ i ].clear();
+		}
+	}
+
+	// v擾
+	PoolAllocator::Statistics PoolAllocator::getStatistics() const {
+		std::lock_guard< std::mutex > lock( mutex_ );
+		return stat_;
+	}
+
+	// 񐔂̓vZbg
+	void PoolAllocator::resetStatistics() {
+		std::lock_guard< std::mutex > lock( mutex_ );
+		Statistics stat;
+		stat.usedBytes_ = stat_.usedBytes_;
+		stat.pooledBytes_ = stat_.pooledBytes_;
+		stat.peakBytes_ = stat_.usedBytes_ + stat_.pooledBytes_;
+		stat_ = stat;
+	}
+}
@@ -0,0 +1,189 @@
+#ifndef __ox_oxmemory_h__
+#define __ox_oxmemory_h__
+
+// m
+
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace OX {
+	class Memory {
+	public:
+		// 傫ȗ̈̊m
+		//  y[WPʂOS璼ڊmۂAq[Wy[Wg
+		//  LinuxmmapMADV_HUGEPAGEwAWindowsSeLockMemoryPrivilegeꍇMEM_LARGE_PAGESŊmۂ
+		//  q[Wy[WgȂł͒ʏ̃y[WɂȂ
+		//  ߂l : mۂłȂꍇ0Be0ŏς
+		static void *allocateLarge( uint64_t size );
+
+		// allocateLargeŊmۂ̈̉
+		//  size : allocateLargeɓnTCY
+		static void freeLarge( void *p, uint64_t size );
+
+		// ̗̈Ƀq[Wy[W𐄏
+		//  y[WE݂̓̂ΏہBLinuxȊOł͉Ȃ
+		static void adviseHugePage( void *p, uint64_t size );
+
+		// allocateLargeg臒lݒ
+		//  size : ̑傫ȏ̉摜allocateLargeŊmۂB0ŖB32MB
+		static void setLargeThreshold( uint64_t size );
+
+		// allocateLargeg臒l擾
+		static uint64_t getLargeThreshold();
+
+		// allocateLargeg傫H
+		static bool isLarge( uint64_t size );
+
+		// 摜ƍƗ̈ɎgAP[^ݒ
+		//  allocator : 0̏ꍇ͊(DefaultAllocator)ɖ߂
+		//  ݒOɊmۂꂽ̈͊mۂAP[^ŉ
+		static void setAllocator( const std::shared_ptr< class Allocator > &allocator );
+
+		// 摜ƍƗ̈ɎgAP[^擾
+		static const std::shared_ptr< class Allocator > &getAllocator();
+	};
+
+	// AP[^
+	//  mۂ̈alignment_goCgEɑ
+	class Allocator {
+	public:
+		static const uint64_t alignment_g = 64;
+
+		Allocator() {}
+		virtual ~Allocator() {}
+
+		// m
+		//  ߂l : mۂłȂꍇ0
+		virtual void *allocate( uint64_t size ) = 0;
+
+		// 
+		//  size : allocateɓnTCY
+		virtual void deallocate( void *p, uint64_t size ) = 0;
+	};
+
+	// ̃AP[^
+	//  VXemۂBMemory::isLargȇ傫Memory::allocateLargeŊmۂ
+	//  mە@̈̑OɋL^̂ŁAmی臒lςĂ
+	class DefaultAllocator : public Allocator {
+	public:
+		virtual void *allocate( uint64_t size ) override;
+		virtual void deallocate( void *p, uint64_t size ) override;
+	};
+
+	// TCYNXɉꂽ̈v[AP[^
+	//  TCYNX2ׂ̂4傫iő25%̐؂グjBNX̊mۂɂ̓v[Ԃ
+	//  VXe̊mۂDefaultAllocatorōsBXbhZ[t
+	class PoolAllocator : public Allocator {
+	public:
+		// v
+		struct Statistics {
+			uint64_t allocateNum_ = 0;		// mۂ̉
+			uint64_t deallocateNum_ = 0;	// ̉
+			uint64_t poolHitNum_ = 0;		// v[Ԃ
+			uint64_t systemAllocateNum_ = 0;	// VXemۂ
+			uint64_t systemFreeNum_ = 0;	// VXeɕԂ
+			uint64_t usedBytes_ = 0;		// gp̃oCgiTCYNXɐ؂グlj
+			uint64_t pooledBytes_ = 0;		// v[̃oCg
+			uint64_t peakBytes_ = 0;		// gpƃv[̍v̍ől
+		};
+
+		// maxPooledBytes : v[ő̃oCgB̓VXeɕԂB0Ŗ
+		PoolAllocator( uint64_t maxPooledBytes = 0 );
+		virtual ~PoolAllocator();
+
+		virtual void *allocate( uint64_t size ) override;
+		virtual void deallocate( void *p, uint64_t size ) override;
+
+		// v[̗̈SăVXeɕԂ
+		void trim();
+
+		// v擾
+		Statistics getStatistics() const;
+
+		// 񐔂̓vZbg
+		//  oCg݂͌̒lێApeakBytes_݂͌̍vɂ
+		void resetStatistics();
+
+		// TCYNX̑傫擾
+		static uint64_t getClassSize( uint64_t size );
+
+	private:
+		// TCYNX̔ԍ擾
+		static uint32_t getClassIndex( uint64_t size );
+
+		// TCYNX̔ԍ傫擾
+		static uint64_t getClassSizeByIndex( uint32_t index );
+
+		DefaultAllocator system_;
+		mutable std::mutex mutex_;
+		std::vector< std::vector< void* > > pools_;	// TCYNX̉ς݂̗̈
+		uint64_t maxPooledBytes_ = 0;
+		Statistics stat_;
+	};
+
+	// AP[^mۂƗ̈
+	//  vf͏ȂBRs[s
+	template< class T >
+	class Buffer {
+	public:
+		Buffer() {}
+		Buffer( uint64_t num, const std::shared_ptr< Allocator > &allocator = Memory::getAllocator() ) {
+			resize( num, allocator );
+		}
+		Buffer( Buffer &&r ) {
+			*this = std::move( r );
+		}
+		~Buffer() {
+			release();
+		}
+
+		Buffer &operator =( Buffer &&r ) {
+			if ( this != &r ) {
+				release();
+				p_ = r.p_;
+				num_ = r.num_;
+				allocator_ = std::move( r.allocator_ );
+				r.p_ = 0;
+				r.num_ = 0;
+			}
+			return *this;
+		}
+
+		// vfύX
+		//  e͕ێȂBvfςȂꍇ͉Ȃ
+		void resize( uint64_t num, const std::shared_ptr< Allocator > &allocator = Memory::getAllocator() ) {
+			if ( num == num_ && allocator == allocator_ )
+				return;
+			release();
+			if ( num == 0 )
+				return;
+			allocator_ = allocator;
+			p_ = (T*)allocator_->allocate( num * sizeof( T ) );
+			num_ = ( p_ ? num : 0 );
+		}
+
+		// 
+		void release() {
+			if ( p_ )
+				allocator_->deallocate( p_, num_ * sizeof( T ) );
+			p_ = 0;
+			num_ = 0;
+		}
+
+		T *data() const { return p_; }
+		uint64_t size() const { return num_; }
+		T &operator []( uint64_t i ) const { return p_[ i ]; }
+
+	private:
+		Buffer( const Buffer & ) = delete;
+		Buffer &operator =( const Buffer & ) = delete;
+
+		T *p_ = 0;
+		uint64_t num_ = 0;
+		std::shared_ptr< Allocator > allocator_;
+	};
+}
+
+#endif
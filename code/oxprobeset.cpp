@@ -0,0 +1,284 @@
+#include "oxprobeset.h"
+#include <string.h>
+#include <math.h>
+#include <sstream>
+#include <algorithm>
+
+namespace OX {
+	namespace SphericalHarmonics {
+
+		uint32_t ProbeSet::magic() {
+			static_assert( sizeof( FileHeader ) == 64, "probe set header must be 64 bytes." );
+			static_assert( sizeof( IndexEntry ) == 16, "probe set index entry must be 16 bytes." );
+			return (uint32_t)'O' | ( (uint32_t)'X' << 8 ) | ( (uint32_t)'P' << 16 ) | ( (uint32_t)'S' << 24 );
+		}
+
+		// i[`̌W̃oCg擾
+		uint64_t ProbeSet::getDataSize( Encoding encoding, uint32_t maxLevel ) {
+			const uint64_t num = 3ull * ( maxLevel + 1 ) * ( maxLevel + 1 );
+			switch ( encoding ) {
+			case Encoding_F64:		return num * sizeof( double );
+			case Encoding_F32:		return num * sizeof( float );
+			case Encoding_F16:		return num * sizeof( uint16_t );
+			case Encoding_BandQ8:	return 3ull * ( maxLevel + 1 ) * sizeof( float ) + num;
+			default:				return 0;
+			}
+		}
+
+		// t@CJ
+		Error ProbeSet::open( const char *filePath ) {
+			close();
+			std::shared_ptr< MappedFile > file = std::make_shared< MappedFile >();
+			if ( file->open( filePath ) == false ) {
+				std::stringstream ss;
+				ss << "failed to open probe set. [" << ( filePath ? filePath : "" ) << "]";
+				return Error( ss.str() );
+			}
+			if ( file->size() < sizeof( FileHeader ) )
+				return Error( "invalid probe set." );
+			FileHeader header;
+			memcpy( &header, file->data(), sizeof( header ) );
+			if ( header.magic_ != magic() )
+				return Error( "not a probe set." );
+			if ( header.version_ == 0 || header.version_ > version_g )
+				return Error( "unsupported probe set version." );
+			if ( header.headerSize_ < sizeof( FileHeader ) || header.indexEntrySize_ < sizeof( IndexEntry ) || header.encoding_ >= Encoding_Num )
+				return Error( "invalid probe set." );
+			if ( header.indexOffset_ > file->size() || ( file->size() - header.indexOffset_ ) / header.indexEntrySize_ < header.probeNum_ )
+				return Error( "probe set index is truncated." );
+			header_ = header;
+			file_ = file;
+			return Error();
+		}
+
+		// 
+		void ProbeSet::close() {
+			file_.reset();
+			header_ = FileHeader();
+		}
+
+		// v[u擾
+		uint64_t ProbeSet::getProbeNum() const {
+			return header_.probeNum_;
+		}
+
+		// W̊i[`擾
+		ProbeSet::Encoding ProbeSet::getEncoding() const {
+			return (Encoding)header_.encoding_;
+		}
+
+		// t@C̃o[W擾
+		uint32_t ProbeSet::getVersion() const {
+			return header_.version_;
+		}
+
+		// v[u擾
+		bool ProbeSet::getProbe( uint64_t idx, Probe &probe ) const {
+			if ( file_ == 0 || idx >= header_.probeNum_ )
+				return false;
+			IndexEntry entry;
+			memcpy( &entry, file_->data() + header_.indexOffset_ + idx * header_.indexEntrySize_, sizeof( entry ) );
+			if ( entry.offset_ > file_->size() || file_->size() - entry.offset_ < entry.size_ )
+				return false;
+			if ( entry.size_ < getDataSize( (Encoding)header_.encoding_, entry.maxLevel_ ) )
+				return false;
+			if ( entry.basis_ > BasisType_HSH )
+				return false;
+			probe.data_ = file_->data() + entry.offset_;
+			probe.size_ = entry.size_;
+			probe.maxLevel_ = entry.maxLevel_;
+			probe.basis_ = (BasisType)entry.basis_;
+			probe.encoding_ = (Encoding)header_.encoding_;
+			return true;
+		}
+
+		// v[u𐄒茋ʂɓWJ
+		Error ProbeSet::getResult( uint64_t idx, Result &res ) const {
+			Probe probe;
+			if ( getProbe( idx, probe ) == false )
+				return Error( "probe index is out of range." );
+
+			const uint32_t num = probe.getCoefNum();
+			std::vector< double > coefs( 3ull * num );
+			const uint8_t *src = probe.getCoefs();
+			switch ( probe.encoding_ ) {
+			case Encoding_F64:
+				memcpy( coefs.data(), src, coefs.size() * sizeof( double ) );
+				break;
+			case Encoding_F32:
+				for ( size_t i = 0; i < coefs.size(); ++i ) {
+					float v;
+					memcpy( &v, src + i * sizeof( float ), sizeof( v ) );
+					coefs[ i ] = v;
+				}
+				break;
+			case Encoding_F16:
+				for ( size_t i = 0; i < coefs.size(); ++i ) {
+					uint16_t v;
+					memcpy( &v, src + i * sizeof( uint16_t ), sizeof( v ) );
+					coefs[ i ] = ImageUtil::halfToFloat( v );
+				}
+				break;
+			case Encoding_BandQ8: {
+				const float *scales = probe.getBandScales();
+				for ( uint32_t c = 0; c < 3; ++c ) {
+					for ( uint32_t l = 0; l <= probe.maxLevel_; ++l ) {
+						const double scale = scales[ c * ( probe.maxLevel_ + 1 ) + l ] / 127.0;
+						for ( uint32_t f = l * l; f < ( l + 1 ) * ( l + 1 ); ++f )
+							coefs[ c * num + f ] = (int8_t)src[ c * num + f ] * scale;
+					}
+				}
+				break;
+			}
+			default:
+				return Error( "unsupported probe encoding." );
+			}
+			res.set( probe.maxLevel_, &coefs[ 0 ], &coefs[ num ], &coefs[ num * 2 ], 1.0, probe.basis_ );
+			return Error();
+		}
+
+
+
+
+		ProbeSetWriter::~ProbeSetWriter() {
+			if ( ofs_.is_open() )
+				close();
+		}
+
+		// t@C쐬
+		//  wb_̗̈󂯂ĂA鎞ɏ
+		Error ProbeSetWriter::open( const char *filePath, ProbeSet::Encoding encoding ) {
+			if ( ofs_.is_open() )
+				close();
+			if ( encoding >= ProbeSet::Encoding_Num )
+				return Error( "unsupported probe encoding." );
+			ofs_.open( filePath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
+			if ( ofs_.is_open() == false ) {
+				std::stringstream ss;
+				ss << "failed to open output file. [" << ( filePath ? filePath : "" ) << "]";
+				return Error( ss.str() );
+			}
+			encoding_ = encoding;
+			maxLevel_ = 0;
+			index_.clear();
+			const ProbeSet::FileHeader header;
+			ofs_.write( (const char*)&header, sizeof( header ) );
+			offset_ = sizeof( header );
+			return Error();
+		}
+
+		// v[uǉ
+		Error ProbeSetWriter::add( const Result &res ) {
+			if ( ofs_.is_open() == false )
+				return Error( "probe set is not opened." );
+			const uint32_t level = res.getMaxLevel();
+			const uint32_t num = ( level + 1 ) * ( level + 1 );
+			if ( res.getCoefNum() < num )
+				return Error( "no estimated parameter." );
+			if ( level > 0xffff )
+				return Error( "too large level for probe set." );
+			const uint64_t dataSize = ProbeSet::getDataSize( encoding_, level );
+			if ( dataSize > 0xffffffff )
+				return Error( "too large level for probe set." );
+			if ( res.getBasisType() > BasisType_HSH )
+				return Error( "unsupported basis type." );
+
+			block_.resize( (size_t)dataSize );
+			uint8_t *dest = block_.data();
+			for ( uint32_t c = 0; c < 3; ++c ) {
+				const CoefSpan< const double > coefs = res.getCoefs( (ColorType)c );
+				switch ( encoding_ ) {
+				case ProbeSet::Encoding_F64:
+					for ( uint32_t i = 0; i < num; ++i )
+						memcpy( dest + ( (uint64_t)c * num + i ) * sizeof( double ), &coefs[ i ], sizeof( double ) );
+					break;
+				case ProbeSet::Encoding_F32:
+					for ( uint32_t i = 0; i < num; ++i ) {
+						const float v = (float)coefs[ i ];
+						memcpy( dest + ( (uint64_t)c * num + i ) * sizeof( float ), &v, sizeof( v ) );
+					}
+					break;
+				case ProbeSet::Encoding_F16:
+					for ( uint32_t i = 0; i < num; ++i ) {
+						const uint16_t v = ImageUtil::floatToHalf( (float)coefs[ i ] );
+						memcpy( dest + ( (uint64_t)c * num + i ) * sizeof( uint16_t ), &v, sizeof( v ) );
+					}
+					break;
+				case ProbeSet::Encoding_BandQ8: {
+					// oh̐Βl̍ő127Ɋ蓖Ă
+					//  ̃oh͒l̂ŁAŜ1̃XP[ɂ萸xc
+					uint8_t *q = dest + 3ull * ( level + 1 ) * sizeof( float );
+					for ( uint32_t l = 0; l <= level; ++l ) {
+						double maxAbs = 0.0;
+						for ( uint32_t f = l * l; f < ( l + 1 ) * ( l + 1 ); ++f )
+							maxAbs = std::max( maxAbs, fabs( coefs[ f ] ) );
+						const float scale = (float)maxAbs;
+						memcpy( dest + ( (uint64_t)c * ( level + 1 ) + l ) * sizeof( float ), &scale, sizeof( scale ) );
+						const double inv = ( scale > 0.0f ? 127.0 / scale : 0.0 );
+						for ( uint32_t f = l * l; f < ( l + 1 ) * ( l + 1 ); ++f ) {
+							const double v = floor( coefs[ f ] * inv + 0.5 );
+							q[ (uint64_t)c * num + f ] = (uint8_t)(int8_t)( v < -127.0 ? -127.0 : ( v > 127.0 ? 127.0 : v ) );
+						}
+					}
+					break;
+				}
+				default:
+					break;
+				}
+			}
+
+			ProbeSet::IndexEntry entry;
+			entry.offset_ = offset_;
+			entry.size_ = (uint32_t)block_.size();
+			entry.maxLevel_ = (uint16_t)level;
+			entry.basis_ = (uint8_t)res.getBasisType();
+			ofs_.write( (const char*)block_.data(), block_.size() );
+			offset_ += block_.size();
+			pad();
+			if ( ofs_.good() == false )
+				return Error( "failed to write probe set." );
+			index_.push_back( entry );
+			maxLevel_ = std::max( maxLevel_, level );
+			return Error();
+		}
+
+		// CfbNXƃwb_oĕ
+		Error ProbeSetWriter::close() {
+			if ( ofs_.is_open() == false )
+				return Error( "probe set is not opened." );
+			ProbeSet::FileHeader header;
+			header.magic_ = ProbeSet::magic();
+			header.version_ = ProbeSet::version_g;
+			header.headerSize_ = sizeof( header );
+			header.encoding_ = encoding_;
+			header.probeNum_ = index_.size();
+			header.indexOffset_ = offset_;
+			header.indexEntrySize_ = sizeof( ProbeSet::IndexEntry );
+			header.alignment_ = ProbeSet::alignment_g;
+			header.maxLevel_ = maxLevel_;
+			if ( index_.size() > 0 )
+				ofs_.write( (const char*)index_.data(), index_.size() * sizeof( ProbeSet::IndexEntry ) );
+			ofs_.seekp( 0 );
+			ofs_.write( (const char*)&header, sizeof( header ) );
+			const bool good = ofs_.good();
+			ofs_.close();
+			index_.clear();
+			return ( good ? Error() : Error( "failed to write probe set." ) );
+		}
+
+		// ǉv[u擾
+		uint64_t ProbeSetWriter::getProbeNum() const {
+			return index_.size();
+		}
+
+		// ACg܂0Ŗ߂
+		void ProbeSetWriter::pad() {
+			static const char zeros[ ProbeSet::alignment_g ] = {};
+			const uint64_t rem = offset_ % ProbeSet::alignment_g;
+			if ( rem == 0 )
+				return;
+			ofs_.write( zeros, ProbeSet::alignment_g - rem );
+			offset_ += ProbeSet::alignment_g - rem;
+		}
+	}
+}
@@ -0,0 +1,153 @@
+#ifndef __ox_oxprobeset_h__
+#define __ox_oxprobeset_h__
+
+// ̐茋ʁiv[uj܂Ƃ߂oCiRei
+
+#include <fstream>
+#include "oxsphericalharmonics.h"
+#include "oxfileutil.h"
+
+namespace OX {
+	namespace SphericalHarmonics {
+
+		// v[uZbg
+		//  wb_Av[ũf[^ACfbNX̏ɕׂ1̃t@C
+		//  wb_64oCgAv[ũf[^ƃCfbNXalignment_goCgEɑ
+		//  t@C}bvACfbNXv[ũf[^𕡐ɎQƂ
+		//  l̓gGfBA
+		class ProbeSet {
+		public:
+			static const uint32_t version_g = 1;		// oo[WBȉ̃o[Wǂݍ߂
+			static const uint32_t alignment_g = 16;		// v[ũf[^ƃCfbNX̃ACg
+
+			// W̊i[`
+			//  W͂ǂ̌`F̕сiRRR...GGG...BBB...j
+			enum Encoding {
+				Encoding_F64,		// {x_
+				Encoding_F32,		// Px_
+				Encoding_F16,		// x_
+				Encoding_BandQ8,	// ohɗʎq8bitBFAoh̃XP[iF32ǰɕt8biťW
+				Encoding_Num
+			};
+
+			// v[ũf[^̎Q
+			//  data_̓}bvt@CwBProbeSet܂ŗL
+			struct Probe {
+				const uint8_t *data_ = 0;
+				uint32_t size_ = 0;		// oCg
+				uint32_t maxLevel_ = 0;
+				BasisType basis_ = BasisType_SH;
+				Encoding encoding_ = Encoding_F64;
+
+				// F̌W̐
+				uint32_t getCoefNum() const { return ( maxLevel_ + 1 ) * ( maxLevel_ + 1 ); }
+
+				// Encoding_BandQ8̃XP[
+				//  3 * ( maxLevel_ + 1 )BFɃoh
+				const float *getBandScales() const { return (const float*)data_; }
+
+				// W̐擪
+				//  Encoding_BandQ8̏ꍇ̓XP[̌
+				const uint8_t *getCoefs() const { return data_ + ( encoding_ == Encoding_BandQ8 ? 3 * ( maxLevel_ + 1 ) * sizeof( float ) : 0 ); }
+			};
+
+			ProbeSet() {}
+			~ProbeSet() {}
+
+			// t@CJ
+			//  wb_ƃCfbNX͈̔͂̂݊mFAv[ũf[^͎QƎ܂œǂ܂Ȃ
+			Error open( const char *filePath );
+
+			// 
+			void close();
+
+			// v[u擾
+			uint64_t getProbeNum() const;
+
+			// W̊i[`擾
+			Encoding getEncoding() const;
+
+			// t@C̃o[W擾
+			uint32_t getVersion() const;
+
+			// v[u擾
+			//  CfbNXŁAf[^͕Ȃ
+			//  ߂l : ͈͊OCfbNXĂꍇfalse
+			bool getProbe( uint64_t idx, Probe &probe ) const;
+
+			// v[u𐄒茋ʂɓWJ
+			//  rešW̕т͂̂܂܎g
+			Error getResult( uint64_t idx, Result &res ) const;
+
+			// i[`̌W̃oCg擾
+			//  Encoding_BandQ8̏ꍇ̓XP[܂
+			static uint64_t getDataSize( Encoding encoding, uint32_t maxLevel );
+
+		private:
+			friend class ProbeSetWriter;
+
+			// t@Cwb_
+			struct FileHeader {
+				uint32_t magic_ = 0;			// 'OXPS'
+				uint32_t version_ = 0;
+				uint32_t headerSize_ = 0;		// wb_̃oCgBVo[Wł͑傫Ȃ蓾
+				uint32_t encoding_ = 0;			// Encoding
+				uint64_t probeNum_ = 0;
+				uint64_t indexOffset_ = 0;		// CfbNX̃t@C擪̃oCgʒu
+				uint32_t indexEntrySize_ = 0;	// CfbNX1vf̃oCg
+				uint32_t alignment_ = 0;		// v[ũf[^̃ACg
+				uint32_t maxLevel_ = 0;			// SẴv[uLevel̍ől
+				uint32_t reserved_[ 5 ] = {};
+			};
+
+			// CfbNX̗vf
+			struct IndexEntry {
+				uint64_t offset_ = 0;	// f[^̃t@C擪̃oCgʒu
+				uint32_t size_ = 0;		// f[^̃oCg
+				uint16_t maxLevel_ = 0;
+				uint8_t basis_ = 0;		// BasisType
+				uint8_t reserved_ = 0;
+			};
+
+			static uint32_t magic();
+
+			std::shared_ptr< MappedFile > file_;
+			FileHeader header_;
+		};
+
+		// v[uZbg̏o
+		//  v[uǉxɃf[^oAɂ̓CfbNX̂ݕێ
+		//  鎞ɃCfbNXoAwb_
+		class ProbeSetWriter {
+		public:
+			ProbeSetWriter() {}
+			~ProbeSetWriter();
+
+			// t@C쐬
+			Error open( const char *filePath, ProbeSet::Encoding encoding );
+
+			// v[uǉ
+			//  LevelƊ̎ނ̓v[uɈقȂĂ悢BWResult̕тɈ˂炸F̕тŏo
+			Error add( const Result &res );
+
+			// CfbNXƃwb_oĕ
+			Error close();
+
+			// ǉv[u擾
+			uint64_t getProbeNum() const;
+
+		private:
+			// ACg܂0Ŗ߂
+			void pad();
+
+			std::ofstream ofs_;
+			ProbeSet::Encoding encoding_ = ProbeSet::Encoding_F64;
+			uint64_t offset_ = 0;		// ooCg
+			uint32_t maxLevel_ = 0;
+			std::vector< ProbeSet::IndexEntry > index_;
+			std::vector< uint8_t > block_;	// 1v[ũf[^
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,703 @@
+#include "oxreconstructor.h"
+#include "oxtexturecontainer.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <limits>
+#include <atomic>
+#include <thread>
+
+namespace OX {
+	namespace SphericalHarmonics {
+
+		// Xbhݒ
+		void Reconstructor::setThreadNum( uint32_t num ) {
+			threadNum_ = num;
+		}
+
+		// Xbh擾
+		uint32_t Reconstructor::getThreadNum() const {
+			if ( threadNum_ > 0 )
+				return threadNum_;
+			const uint32_t num = std::thread::hardware_concurrency();
+			return ( num > 0 ? num : 1 );
+		}
+
+		// ^C̕ӂ̃eNZݒ
+		void Reconstructor::setTileSize( uint32_t size ) {
+			tileSize_ = ( size > 0 ? size : 1 );
+		}
+
+		// č\p[^ݒ
+		bool Reconstructor::setResult( const Result &res ) {
+			const uint32_t level = res.getMaxLevel();
+			const uint32_t fnum = ( level + 1 ) * ( level + 1 );
+			if ( res.getCoefNum() < fnum )
+				return false;
+			const auto paramR = res.getCoefs( ColorType::ColorType_R );
+			const auto paramG = res.getCoefs( ColorType::ColorType_G );
+			const auto paramB = res.getCoefs( ColorType::ColorType_B );
+
+			if ( level != level_ || norm_.size() == 0 ) {
+				// K_l_m = sqrt((2 - _m0) * (2l + 1) / 4 * (l - m)! / (l + m)!)
+				norm_.resize( fnum );
+				for ( uint32_t l = 0; l <= level; ++l ) {
+					for ( uint32_t m = 0; m <= l; ++m ) {
+						double f = 1.0;
+						for ( uint32_t i = l - m + 1; i <= l + m; ++i )
+							f /= i;
+						double c = ( 2 * l + 1 ) / ( 4.0 * 3.14159265358979323846 ) * f;
+						norm_[ l * ( level + 1 ) + m ] = sqrt( m == 0 ? c : 2.0 * c );
+					}
+				}
+			}
+			level_ = level;
+			fnum_ = fnum;
+			basis_ = res.getBasisType();
+			coefs_.resize( 3ull * fnum );
+			for ( uint32_t i = 0; i < fnum; ++i ) {
+				coefs_[ i ] = paramR[ i ];
+				coefs_[ fnum + i ] = paramG[ i ];
+				coefs_[ fnum * 2 + i ] = paramB[ i ];
+			}
+			return true;
+		}
+
+		// ob`̊̕l]
+		//  o͂basis_[ idx * batchSize_g + lane ]B[̃[vœɂĎxNg
+		void Reconstructor::evalBatch( const double *x, const double *y, const double *z, Scratch &scratch ) const {
+			const uint32_t B = batchSize_g;
+			double *out = scratch.basis_.data();
+
+			if ( basis_ == BasisType_HSH ) {
+				// a֐1]ĕבւ
+				double *lane = scratch.lane_.data();
+				for ( uint32_t j = 0; j < B; ++j ) {
+					if ( y[ j ] < 0.0 ) {
+						for ( uint32_t i = 0; i < fnum_; ++i )
+							out[ i * B + j ] = 0.0;
+						continue;
+					}
+					evalHemisphericalHarmonics( level_, x[ j ], y[ j ], z[ j ], lane );
+					for ( uint32_t i = 0; i < fnum_; ++i )
+						out[ i * B + j ] = lane[ i ];
+				}
+				return;
+			}
+
+			// evalSphericalHarmonicsƓQbatchSize_g܂Ƃ߂ČvZ
+			double cm[ B ], sm[ B ];	// (x + iz)^m̎A
+			double p1[ B ], p2[ B ];
+			for ( uint32_t j = 0; j < B; ++j ) {
+				cm[ j ] = 1.0;
+				sm[ j ] = 0.0;
+			}
+			double pmm = 1.0;			// P_m_m̑iɈ˂Ȃj
+			for ( uint32_t m = 0; m <= level_; ++m ) {
+				if ( m > 0 ) {
+					for ( uint32_t j = 0; j < B; ++j ) {
+						double c = cm[ j ] * x[ j ] - sm[ j ] * z[ j ];
+						sm[ j ] = cm[ j ] * z[ j ] + sm[ j ] * x[ j ];
+						cm[ j ] = c;
+					}
+					pmm *= -( 2.0 * m - 1.0 );
+				}
+				for ( uint32_t l = m; l <= level_; ++l ) {
+					const double k = norm_[ l * ( level_ + 1 ) + m ];
+					double *oc = out + Parameter::toIdx( l, m ) * B;
+					double *os = out + Parameter::toIdx( l, -(int32_t)m ) * B;
+					if ( l == m ) {
+						for ( uint32_t j = 0; j < B; ++j ) {
+							p2[ j ] = 0.0;
+							p1[ j ] = pmm;
+						}
+					} else if ( l == m + 1 ) {
+						const double a = ( 2.0 * m + 1 ) * pmm;
+						for ( uint32_t j = 0; j < B; ++j ) {
+							p2[ j ] = p1[ j ];
+							p1[ j ] = y[ j ] * a;
+						}
+					} else {
+						const double a = ( 2.0 * l - 1 ) / ( l - m );
+						const double b = (double)( l + m - 1 ) / ( l - m );
+						for ( uint32_t j = 0; j < B; ++j ) {
+							double p = y[ j ] * a * p1[ j ] - b * p2[ j ];
+							p2[ j ] = p1[ j ];
+							p1[ j ] = p;
+						}
+					}
+					if ( m == 0 ) {
+						for ( uint32_t j = 0; j < B; ++j )
+							oc[ j ] = k * p1[ j ];
+					} else {
+						for ( uint32_t j = 0; j < B; ++j ) {
+							oc[ j ] = k * p1[ j ] * cm[ j ];
+							os[ j ] = k * p1[ j ] * sm[ j ];
+						}
+					}
+				}
+			}
+		}
+
+		// ob`̒̕lZo
+		void Reconstructor::evalColors( const double *x, const double *y, const double *z, uint32_t num, float *rgba, Scratch &scratch ) const {
+			const uint32_t B = batchSize_g;
+			const double *coefR = coefs_.data();
+			const double *coefG = coefR + fnum_;
+			const double *coefB = coefG + fnum_;
+			const double *basis = scratch.basis_.data();
+			evalBatch( x, y, z, scratch );
+
+			double r[ B ], g[ B ], b[ B ];
+			for ( uint32_t j = 0; j < B; ++j )
+				r[ j ] = g[ j ] = b[ j ] = 0.0;
+			for ( uint32_t i = 0; i < fnum_; ++i ) {
+				const double *bv = basis + i * B;
+				const double cr = coefR[ i ], cg = coefG[ i ], cb = coefB[ i ];
+				for ( uint32_t j = 0; j < B; ++j ) {
+					r[ j ] += cr * bv[ j ];
+					g[ j ] += cg * bv[ j ];
+					b[ j ] += cb * bv[ j ];
+				}
+			}
+
+			// ̒l0ɃNv
+			for ( uint32_t j = 0; j < num; ++j ) {
+				rgba[ j * 4 + 0 ] = (float)( r[ j ] < 0.0 ? 0.0 : r[ j ] );
+				rgba[ j * 4 + 1 ] = (float)( g[ j ] < 0.0 ? 0.0 : g[ j ] );
+				rgba[ j * 4 + 2 ] = (float)( b[ j ] < 0.0 ? 0.0 : b[ j ] );
+				rgba[ j * 4 + 3 ] = 1.0f;
+			}
+		}
+
+		// ̒lZo
+		//  [̃ob`͎c̃[Ō̕Ŗ߂
+		void Reconstructor::evaluate( const double *x, const double *y, const double *z, uint64_t num, float *rgba ) {
+			const uint32_t B = batchSize_g;
+			if ( fnum_ == 0 )
+				return;
+			prepareScratch( 1, 0 );
+			Scratch &scratch = scratch_[ 0 ];
+			double bx[ B ], by[ B ], bz[ B ];
+			for ( uint64_t i = 0; i < num; i += B ) {
+				const uint32_t n = (uint32_t)( num - i < B ? num - i : B );
+				for ( uint32_t j = 0; j < B; ++j ) {
+					const uint64_t k = i + ( j < n ? j : n - 1 );
+					bx[ j ] = x[ k ];
+					by[ j ] = y[ k ];
+					bz[ j ] = z[ k ];
+				}
+				evalColors( bx, by, bz, n, rgba + i * 4, scratch );
+			}
+		}
+
+		// ^C
+		//  tile͏o͐̕тł̈ʒuB]ꍇ͎𔽓]Ėʂ̕߂
+		void Reconstructor::processTile( const Tile &tile, uint32_t width, const ImageBlock::PixelFormat &format, ImageUtil::RowEncoder encoder, const FaceTarget &target, Scratch &scratch ) const {
+			const uint32_t B = batchSize_g;
+			double axis[ 3 ], du[ 3 ], dv[ 3 ];
+			CubeData::getFaceBasis( (CubeData::Face)tile.face_, axis, du, dv );
+			if ( target.rotated_ ) {
+				for ( int i = 0; i < 3; ++i ) {
+					du[ i ] = -du[ i ];
+					dv[ i ] = -dv[ i ];
+				}
+			}
+			const uint32_t bpc = format.bytePerColor();
+			float *rgba = scratch.rgba_.data();
+
+			double x[ B ], y[ B ], z[ B ];
+			for ( uint32_t tv = tile.v_; tv < tile.v_ + tile.h_; ++tv ) {
+				const double t = ( 2.0 * tv + 1.0 ) / width - 1.0;
+				for ( uint32_t u0 = 0; u0 < tile.w_; u0 += B ) {
+					// ͂ݏo[͍Ō̃eNZŖ߂
+					const uint32_t num = ( tile.w_ - u0 < B ? tile.w_ - u0 : B );
+					for ( uint32_t j = 0; j < B; ++j ) {
+						const uint32_t tu = tile.u_ + u0 + ( j < num ? j : num - 1 );
+						const double s = ( 2.0 * tu + 1.0 ) / width - 1.0;
+						double dx = axis[ 0 ] + s * du[ 0 ] + t * dv[ 0 ];
+						double dy = axis[ 1 ] + s * du[ 1 ] + t * dv[ 1 ];
+						double dz = axis[ 2 ] + s * du[ 2 ] + t * dv[ 2 ];
+						double il = 1.0 / sqrt( dx * dx + dy * dy + dz * dz );
+						x[ j ] = dx * il;
+						y[ j ] = dy * il;
+						z[ j ] = dz * il;
+					}
+					evalColors( x, y, z, num, rgba + u0 * 4, scratch );
+				}
+
+				// ^C̍s܂Ƃ߂ďo͂̐FԂƌ`ɕϊ
+				ImageUtil::encodeColorSpaceRow( rgba, tile.w_, format );
+				encoder( rgba, tile.w_, target.origin_ + target.pitch_ * tv + (uint64_t)tile.u_ * bpc );
+			}
+		}
+
+		// ԍ^C擾
+		Reconstructor::Tile Reconstructor::getTile( uint64_t idx, uint32_t width ) const {
+			const uint32_t tileNum = ( width + tileSize_ - 1 ) / tileSize_;
+			const uint64_t faceTileNum = (uint64_t)tileNum * tileNum;
+			Tile tile;
+			tile.face_ = (uint32_t)( idx / faceTileNum );
+			const uint32_t rem = (uint32_t)( idx % faceTileNum );
+			tile.u_ = ( rem % tileNum ) * tileSize_;
+			tile.v_ = ( rem / tileNum ) * tileSize_;
+			tile.w_ = ( width - tile.u_ < tileSize_ ? width - tile.u_ : tileSize_ );
+			tile.h_ = ( width - tile.v_ < tileSize_ ? width - tile.v_ : tileSize_ );
+			return tile;
+		}
+
+		// Xbh̍Ɨ̈p
+		void Reconstructor::prepareScratch( uint32_t threadNum, uint64_t rgbaNum ) {
+			if ( scratch_.size() < threadNum )
+				scratch_.resize( threadNum );
+			for ( uint32_t i = 0; i < threadNum; ++i ) {
+				Scratch &scratch = scratch_[ i ];
+				if ( scratch.basis_.size() < (uint64_t)fnum_ * batchSize_g )
+					scratch.basis_.resize( (uint64_t)fnum_ * batchSize_g );
+				if ( scratch.lane_.size() < fnum_ )
+					scratch.lane_.resize( fnum_ );
+				if ( scratch.rgba_.size() < rgbaNum )
+					scratch.rgba_.resize( rgbaNum );
+				if ( scratch.ring_.size() < 6ull * ( level_ + 1 ) )
+					scratch.ring_.resize( 6ull * ( level_ + 1 ) );
+			}
+		}
+
+		// ^XNĂяoXbhƍ쐬XbhŕSď
+		template< class Task >
+		void Reconstructor::dispatch( uint64_t taskNum, uint32_t threadNum, uint64_t procCount, const Task &task, const std::function< void( uint64_t count, uint64_t procCount ) > &proc ) {
+			std::atomic< uint64_t > next( 0 );
+			std::atomic< uint64_t > count( 0 );
+			auto work = [ & ]( Scratch &scratch, bool isCaller ) {
+				for ( ;; ) {
+					const uint64_t idx = next++;
+					if ( idx >= taskNum )
+						break;
+					const uint64_t c = ( count += task( idx, scratch ) );
+					if ( isCaller )
+						proc( c, procCount );
+				}
+			};
+			std::vector< std::thread > threads;
+			if ( threadNum > 1 ) {
+				threads.reserve( threadNum - 1 );
+				for ( uint32_t i = 1; i < threadNum; ++i )
+					threads.emplace_back( work, std::ref( scratch_[ i ] ), false );
+			}
+			work( scratch_[ 0 ], true );
+			for ( auto &t : threads )
+				t.join();
+			proc( procCount, procCount );
+		}
+
+		// 6ʂč\
+		bool Reconstructor::reconstruct( uint32_t width, const ImageBlock::PixelFormat &format, const FaceTarget *targets, const std::function< void( uint64_t count, uint64_t procCount ) > &proc ) {
+			if ( fnum_ == 0 || width == 0 )
+				return false;
+			ImageUtil::RowEncoder encoder = ImageUtil::getRowEncoder( format );
+			if ( encoder == 0 )
+				return false;
+
+			const uint32_t tileNum = ( width + tileSize_ - 1 ) / tileSize_;
+			const uint64_t allTileNum = (uint64_t)tileNum * tileNum * CubeData::Face::Face_Num;
+			const uint64_t procCount = (uint64_t)width * width * CubeData::Face::Face_Num;
+			uint32_t threadNum = getThreadNum();
+			if ( threadNum > allTileNum )
+				threadNum = (uint32_t)allTileNum;
+			prepareScratch( threadNum, ( (uint64_t)tileSize_ + batchSize_g ) * 4 );
+
+			// ^CɎoď
+			dispatch( allTileNum, threadNum, procCount, [ & ]( uint64_t idx, Scratch &scratch ) {
+				const Tile tile = getTile( idx, width );
+				processTile( tile, width, format, encoder, targets[ tile.face_ ], scratch );
+				return (uint64_t)tile.w_ * tile.h_;
+			}, proc );
+			return true;
+		}
+
+		// 6ʂ̉摜ɍč\
+		bool Reconstructor::reconstruct( ImageBlock *faces, const std::function< void( uint64_t count, uint64_t procCount ) > &proc ) {
+			if ( faces[ 0 ].isExist() == false )
+				return false;
+			const uint32_t width = faces[ 0 ].width();
+			const ImageBlock::PixelFormat &format = faces[ 0 ].format();
+			FaceTarget targets[ CubeData::Face::Face_Num ];
+			for ( uint32_t f = 0; f < CubeData::Face::Face_Num; ++f ) {
+				const ImageBlock::PixelFormat &ff = faces[ f ].format();
+				if ( faces[ f ].width() != width || faces[ f ].height() != width ||
+					ff.channelNum_ != format.channelNum_ || ff.type_ != format.type_ || ff.colorSpace_ != format.colorSpace_ || ff.gamma_ != format.gamma_ )
+					return false;
+				targets[ f ].origin_ = faces[ f ].p();
+				targets[ f ].pitch_ = faces[ f ].pitch();
+			}
+			return reconstruct( width, format, targets, proc );
+		}
+
+		// ~}@1s
+		//  oxɈ˂Ȃ̓ = 0̊̕l狁߂i(x + iz)^msin^m()܂ށj
+		void Reconstructor::processEquirectRow( uint32_t v, ImageBlock &image, ImageUtil::RowEncoder encoder, Scratch &scratch ) const {
+			const uint32_t width = image.width();
+			const uint32_t L = level_ + 1;
+			const double th = 3.14159265358979323846 * ( v + 0.5 ) / image.height();
+			const double x = sin( th ), y = cos( th );
+			double *basis = scratch.basis_.data();
+			if ( basis_ == BasisType_HSH ) {
+				if ( y < 0.0 ) {
+					for ( uint32_t i = 0; i < fnum_; ++i )
+						basis[ i ] = 0.0;
+				} else {
+					evalHemisphericalHarmonics( level_, x, y, 0.0, basis );
+				}
+			} else {
+				evalSphericalHarmonics( level_, x, y, 0.0, basis );
+			}
+
+			// Fcos(m)Asin(m)̌W
+			double *ring = scratch.ring_.data();
+			for ( uint32_t c = 0; c < 3; ++c ) {
+				const double *coef = coefs_.data() + (uint64_t)fnum_ * c;
+				double *a = ring + ( c * 2 ) * L;
+				double *b = ring + ( c * 2 + 1 ) * L;
+				for ( uint32_t m = 0; m <= level_; ++m ) {
+					double sa = 0.0, sb = 0.0;
+					for ( uint32_t l = m; l <= level_; ++l ) {
+						const double p = basis[ Parameter::toIdx( l, m ) ];
+						sa += coef[ Parameter::toIdx( l, m ) ] * p;
+						if ( m > 0 )
+							sb += coef[ Parameter::toIdx( l, -(int32_t)m ) ] * p;
+					}
+					a[ m ] = sa;
+					b[ m ] = sb;
+				}
+			}
+
+			//  a_m cos(m) = a_0 + y_1 cos() - y_2A b_m sin(m) = z_1 sin()
+			//  y_k = a_k + 2cos()y_k+1 - y_k+2izlj
+			float *rgba = scratch.rgba_.data();
+			const double *phi = phi_.data();
+			for ( uint32_t u = 0; u < width; ++u ) {
+				const double cp = phi[ u * 2 ], sp = phi[ u * 2 + 1 ];
+				for ( uint32_t c = 0; c < 3; ++c ) {
+					const double *a = ring + ( c * 2 ) * L;
+					const double *b = ring + ( c * 2 + 1 ) * L;
+					double y1 = 0.0, y2 = 0.0, z1 = 0.0, z2 = 0.0;
+					for ( uint32_t k = level_; k >= 1; --k ) {
+						const double yk = a[ k ] + 2.0 * cp * y1 - y2;
+						const double zk = b[ k ] + 2.0 * cp * z1 - z2;
+						y2 = y1;
+						y1 = yk;
+						z2 = z1;
+						z1 = zk;
+					}
+					const double value = a[ 0 ] + y1 * cp - y2 + z1 * sp;
+					rgba[ u * 4 + c ] = (float)( value < 0.0 ? 0.0 : value );
+				}
+				rgba[ u * 4 + 3 ] = 1.0f;
+			}
+			ImageUtil::encodeColorSpaceRow( rgba, width, image.format() );
+			encoder( rgba, width, image.row( v ) );
+		}
+
+		// ~}@iܓxoxj̉摜ɍč\
+		bool Reconstructor::reconstructEquirect( ImageBlock &image, const std::function< void( uint64_t count, uint64_t procCount ) > &proc ) {
+			if ( fnum_ == 0 || image.isExist() == false )
+				return false;
+			ImageUtil::RowEncoder encoder = ImageUtil::getRowEncoder( image.format() );
+			if ( encoder == 0 )
+				return false;
+			const uint32_t width = image.width();
+			const uint32_t height = image.height();
+
+			// 񖈂cos()Asin()
+			phi_.resize( (uint64_t)width * 2 );
+			for ( uint32_t u = 0; u < width; ++u ) {
+				const double phi = 2.0 * 3.14159265358979323846 * ( u + 0.5 ) / width;
+				phi_[ u * 2 ] = cos( phi );
+				phi_[ u * 2 + 1 ] = sin( phi );
+			}
+
+			uint32_t threadNum = getThreadNum();
+			if ( threadNum > height )
+				threadNum = height;
+			prepareScratch( threadNum, (uint64_t)width * 4 );
+			dispatch( height, threadNum, (uint64_t)width * height, [ & ]( uint64_t v, Scratch &scratch ) {
+				processEquirectRow( (uint32_t)v, image, encoder, scratch );
+				return (uint64_t)width;
+			}, proc );
+			return true;
+		}
+
+		// 덷Zo1s
+		//  eNZ̗̊p͐Ɠ1 / l^3 * 4 / w^2
+		void Reconstructor::processErrorRow( const CubeData *cube, uint32_t face, uint32_t v, std::vector< ImageBlock > *heatmaps, Scratch &scratch ) const {
+			const uint32_t B = batchSize_g;
+			const uint32_t width = cube->getTexelSize();
+			const bool hasMask = cube->hasMask();
+			double axis[ 3 ], du[ 3 ], dv[ 3 ];
+			CubeData::getFaceBasis( (CubeData::Face)face, axis, du, dv );
+			float *input = scratch.input_.data();
+			float *rgba = scratch.rgba_.data();
+			float *heat = ( heatmaps ? (float*)( *heatmaps )[ face ].row( v ) : 0 );
+			cube->getRow( (CubeData::Face)face, v, input );
+
+			const double t = ( 2.0 * v + 1.0 ) / width - 1.0;
+			const double texelArea = 4.0 / ( (double)width * width );
+			double x[ B ], y[ B ], z[ B ], w[ B ];
+			for ( uint32_t u0 = 0; u0 < width; u0 += B ) {
+				const uint32_t num = ( width - u0 < B ? width - u0 : B );
+				for ( uint32_t j = 0; j < B; ++j ) {
+					const uint32_t tu = u0 + ( j < num ? j : num - 1 );
+					const double s = ( 2.0 * tu + 1.0 ) / width - 1.0;
+					double dx = axis[ 0 ] + s * du[ 0 ] + t * dv[ 0 ];
+					double dy = axis[ 1 ] + s * du[ 1 ] + t * dv[ 1 ];
+					double dz = axis[ 2 ] + s * du[ 2 ] + t * dv[ 2 ];
+					double il = 1.0 / sqrt( dx * dx + dy * dy + dz * dz );
+					x[ j ] = dx * il;
+					y[ j ] = dy * il;
+					z[ j ] = dz * il;
+					w[ j ] = il * il * il * texelArea;
+				}
+				evalColors( x, y, z, num, rgba, scratch );
+
+				for ( uint32_t j = 0; j < num; ++j ) {
+					const uint32_t tu = u0 + j;
+					double weight = w[ j ];
+					if ( hasMask )
+						weight *= cube->getWeight( (CubeData::Face)face, tu, v );
+					const float *src = input + tu * 4;
+					double sq = 0.0;
+					for ( int c = 0; c < 3; ++c ) {
+						const double d = (double)rgba[ j * 4 + c ] - src[ c ];
+						sq += d * d;
+						if ( weight > 0.0 ) {
+							scratch.errorSum_[ face ][ c ] += weight * d * d;
+							if ( fabs( d ) > scratch.maxError_ )
+								scratch.maxError_ = fabs( d );
+							if ( src[ c ] > scratch.maxValue_ )
+								scratch.maxValue_ = src[ c ];
+						}
+					}
+					if ( weight > 0.0 )
+						scratch.weightSum_[ face ] += weight;
+					if ( heat )
+						heat[ tu ] = ( weight > 0.0 ? (float)sqrt( sq / 3.0 ) : 0.0f );
+				}
+			}
+		}
+
+		// ͂̃L[u}bvƂ̌덷Zo
+		bool Reconstructor::measureError( const CubeData *cube, double peak, ErrorMetrics &metrics, std::vector< ImageBlock > *heatmaps, const std::function< void( uint64_t count, uint64_t procCount ) > &proc ) {
+			metrics = ErrorMetrics();
+			if ( fnum_ == 0 || cube == 0 || cube->getTexelSize() == 0 )
+				return false;
+			const uint32_t width = cube->getTexelSize();
+			if ( heatmaps ) {
+				ImageBlock::PixelFormat format( 1, ImageBlock::ComponentType_F32 );
+				heatmaps->resize( 6 );
+				for ( auto &image : *heatmaps ) {
+					if ( image.isExist() == false || image.width() != width || image.height() != width || image.channelNum() != 1 || image.componentType() != ImageBlock::ComponentType_F32 || image.pitch() != width * sizeof( float ) )
+						image = ImageBlockCustom( width, width, format, 0 );
+				}
+			}
+
+			const uint64_t rowNum = (uint64_t)width * CubeData::Face::Face_Num;
+			uint32_t threadNum = getThreadNum();
+			if ( threadNum > rowNum )
+				threadNum = (uint32_t)rowNum;
+			prepareScratch( threadNum, (uint64_t)batchSize_g * 4 );
+			for ( uint32_t i = 0; i < threadNum; ++i ) {
+				Scratch &scratch = scratch_[ i ];
+				if ( scratch.input_.size() < (uint64_t)width * 4 )
+					scratch.input_.resize( (uint64_t)width * 4 );
+				memset( scratch.errorSum_, 0, sizeof( scratch.errorSum_ ) );
+				memset( scratch.weightSum_, 0, sizeof( scratch.weightSum_ ) );
+				scratch.maxError_ = 0.0;
+				scratch.maxValue_ = 0.0;
+			}
+			dispatch( rowNum, threadNum, rowNum * width, [ & ]( uint64_t idx, Scratch &scratch ) {
+				processErrorRow( cube, (uint32_t)( idx / width ), (uint32_t)( idx % width ), heatmaps, scratch );
+				return (uint64_t)width;
+			}, proc );
+
+			// Xbh̘a܂Ƃ߂
+			double errorSum[ 6 ][ 3 ] = {}, weightSum[ 6 ] = {};
+			double maxValue = 0.0;
+			for ( uint32_t i = 0; i < threadNum; ++i ) {
+				const Scratch &scratch = scratch_[ i ];
+				for ( int f = 0; f < 6; ++f ) {
+					for ( int c = 0; c < 3; ++c )
+						errorSum[ f ][ c ] += scratch.errorSum_[ f ][ c ];
+					weightSum[ f ] += scratch.weightSum_[ f ];
+				}
+				metrics.maxError_ = std::max( metrics.maxError_, scratch.maxError_ );
+				maxValue = std::max( maxValue, scratch.maxValue_ );
+			}
+			double allError = 0.0, allWeight = 0.0;
+			for ( int f = 0; f < 6; ++f ) {
+				const double e = errorSum[ f ][ 0 ] + errorSum[ f ][ 1 ] + errorSum[ f ][ 2 ];
+				metrics.faceRmse_[ f ] = ( weightSum[ f ] > 0.0 ? sqrt( e / ( 3.0 * weightSum[ f ] ) ) : 0.0 );
+				allError += e;
+				allWeight += weightSum[ f ];
+			}
+			if ( allWeight <= 0.0 )
+				return false;
+			for ( int c = 0; c < 3; ++c ) {
+				double e = 0.0;
+				for ( int f = 0; f < 6; ++f )
+					e += errorSum[ f ][ c ];
+				metrics.channelRmse_[ c ] = sqrt( e / allWeight );
+			}
+			metrics.rmse_ = sqrt( allError / ( 3.0 * allWeight ) );
+			metrics.peak_ = ( peak > 0.0 ? peak : maxValue );
+			metrics.psnr_ = ( metrics.rmse_ > 0.0 ? 20.0 * log10( metrics.peak_ / metrics.rmse_ ) : std::numeric_limits< double >::infinity() );
+			return true;
+		}
+
+
+
+		// 쐬
+		Error CubeMipChain::create( const Result &res, uint32_t width, uint32_t mipNum, const ImageBlock::PixelFormat &format, const std::function< void( uint64_t count, uint64_t procCount ) > &proc ) {
+			if ( width == 0 )
+				return Error( "invalid cube map size." );
+			ImageUtil::RowEncoder encoder = ImageUtil::getRowEncoder( format );
+			if ( encoder == 0 )
+				return Error( "unsupported pixel format." );
+			if ( reconstructor_.setResult( res ) == false )
+				return Error( "parameters are not enough for the level." );
+
+			uint32_t fullNum = 1;
+			while ( ( width >> fullNum ) > 0 )
+				++fullNum;
+			mipNum = ( mipNum == 0 || mipNum > fullNum ? fullNum : mipNum );
+			width_ = width;
+			mipNum_ = mipNum;
+			format_ = format;
+
+			// ʁA~bv̏ɋl߂ʒu
+			const uint32_t bpc = format.bytePerColor();
+			offsets_.resize( 6 * mipNum );
+			uint64_t offset = 0;
+			for ( uint32_t f = 0; f < 6; ++f ) {
+				for ( uint32_t mip = 0; mip < mipNum; ++mip ) {
+					const uint64_t w = getTexelSize( mip );
+					offsets_[ f * mipNum + mip ] = offset;
+					offset += w * w * bpc;
+				}
+			}
+			dataSize_ = offset;
+			data_.resize( dataSize_ );
+			if ( data_.data() == 0 )
+				return Error( "failed to allocate memory." );
+
+			// ~bv0jARGBAōč\
+			const uint64_t faceFloatNum = (uint64_t)width * width * 4;
+			linear_[ 0 ].resize( faceFloatNum * 6 );
+			if ( mipNum > 1 )
+				linear_[ 1 ].resize( (uint64_t)( width / 2 ) * ( width / 2 ) * 4 * 6 );
+			row_.resize( (uint64_t)width * 4 );
+			if ( linear_[ 0 ].data() == 0 || ( mipNum > 1 && linear_[ 1 ].data() == 0 ) || row_.data() == 0 )
+				return Error( "failed to allocate memory." );
+			Reconstructor::FaceTarget targets[ 6 ];
+			for ( uint32_t f = 0; f < 6; ++f ) {
+				targets[ f ].origin_ = (uint8_t*)( linear_[ 0 ].data() + faceFloatNum * f );
+				targets[ f ].pitch_ = (uint64_t)width * 4 * sizeof( float );
+			}
+			if ( reconstructor_.reconstruct( width, ImageBlock::PixelFormat( 4, ImageBlock::ComponentType_F32 ), targets, proc ) == false )
+				return Error( "failed to reconstruct cube map." );
+
+			// ~bvɏo͂̌`ɕϊÃ~bvkč
+			for ( uint32_t mip = 0; mip < mipNum; ++mip ) {
+				const uint32_t w = getTexelSize( mip );
+				const float *linear = linear_[ mip % 2 ].data();
+				for ( uint32_t f = 0; f < 6; ++f ) {
+					uint8_t *dest = data_.data() + offsets_[ f * mipNum + mip ];
+					for ( uint32_t v = 0; v < w; ++v ) {
+						memcpy( row_.data(), linear + ( ( (uint64_t)f * w + v ) * w ) * 4, (uint64_t)w * 4 * sizeof( float ) );
+						ImageUtil::encodeColorSpaceRow( row_.data(), w, format );
+						encoder( row_.data(), w, dest + (uint64_t)v * w * bpc );
+					}
+				}
+				if ( mip + 1 < mipNum )
+					downsample( linear, w, linear_[ ( mip + 1 ) % 2 ].data() );
+			}
+			return Error();
+		}
+
+		// ̊pŏdݕt1/2ɏk
+		//  eNZ̗̊p(1 + s^2 + t^2)^(-3/2)ɔ
+		void CubeMipChain::downsample( const float *src, uint32_t width, float *dest ) {
+			const uint32_t dw = ( width / 2 > 0 ? width / 2 : 1 );
+			for ( uint32_t f = 0; f < 6; ++f ) {
+				const float *face = src + (uint64_t)f * width * width * 4;
+				float *out = dest + (uint64_t)f * dw * dw * 4;
+				for ( uint32_t v = 0; v < dw; ++v ) {
+					for ( uint32_t u = 0; u < dw; ++u ) {
+						double sum[ 4 ] = {}, wsum = 0.0;
+						for ( uint32_t j = 0; j < 2; ++j ) {
+							const uint32_t sv = ( 2 * v + j < width ? 2 * v + j : width - 1 );
+							const double t = ( 2.0 * sv + 1.0 ) / width - 1.0;
+							for ( uint32_t i = 0; i < 2; ++i ) {
+								const uint32_t su = ( 2 * u + i < width ? 2 * u + i : width - 1 );
+								const double s = ( 2.0 * su + 1.0 ) / width - 1.0;
+								const double d = 1.0 + s * s + t * t;
+								const double weight = 1.0 / ( d * sqrt( d ) );
+								const float *texel = face + ( (uint64_t)sv * width + su ) * 4;
+								for ( int c = 0; c < 4; ++c )
+									sum[ c ] += texel[ c ] * weight;
+								wsum += weight;
+							}
+						}
+						for ( int c = 0; c < 4; ++c )
+							out[ ( (uint64_t)v * dw + u ) * 4 + c ] = (float)( sum[ c ] / wsum );
+					}
+				}
+			}
+		}
+
+		// č\̃Xbhݒ
+		void CubeMipChain::setThreadNum( uint32_t num ) {
+			reconstructor_.setThreadNum( num );
+		}
+
+		// ~bv擾
+		uint32_t CubeMipChain::getMipNum() const {
+			return mipNum_;
+		}
+
+		// ʂ̃eNZ擾
+		uint32_t CubeMipChain::getTexelSize( uint32_t mip ) const {
+			if ( mip >= mipNum_ )
+				return 0;
+			return ( width_ >> mip ? width_ >> mip : 1 );
+		}
+
+		// sNZtH[}bg擾
+		const ImageBlock::PixelFormat &CubeMipChain::getPixelFormat() const {
+			return format_;
+		}
+
+		// 1ʕ̉摜擾
+		ImageBlock CubeMipChain::getFace( uint32_t mip, uint32_t face ) const {
+			if ( mip >= mipNum_ || face >= 6 )
+				return ImageBlock();
+			const uint32_t w = getTexelSize( mip );
+			return ImageBlockRef( w, w, format_, data_.data() + offsets_[ face * mipNum_ + mip ] );
+		}
+
+		// S~bṽf[^擾
+		const uint8_t *CubeMipChain::data() const {
+			return data_.data();
+		}
+
+		uint64_t CubeMipChain::size() const {
+			return dataSize_;
+		}
+
+		// DDSŕۑ
+		Error CubeMipChain::saveDDS( const char *filePath ) const {
+			if ( mipNum_ == 0 )
+				return Error( "mip chain is not created." );
+			return TextureContainer::saveDDS( filePath, width_, mipNum_, format_, data_.data(), dataSize_ );
+		}
+	}
+}
@@ -0,0 +1,212 @@
+#ifndef __ox_oxreconstructor_h__
+#define __ox_oxreconstructor_h__
+
+// p[^̃L[u}bvA~}@̉摜̍č\
+
+#include "oxsphericalharmonics.h"
+
+namespace OX {
+	namespace SphericalHarmonics {
+
+		// L[u}bvA~}@̉摜̍č\
+		//  ʂ^CɕăXbhɊ蓖āA^C̍sbatchSize_geNZ܂Ƃ߂Ċ]
+		//  l̓eNZœ̕тɂĕێAWƂ̐ϘaƏo͌`ւ̕ϊ𓯂pXōs
+		class Reconstructor {
+		public:
+			static const uint32_t batchSize_g = 16;	// 1xɊ]eNZ
+
+			Reconstructor() {}
+			~Reconstructor() {}
+
+			// Xbhݒ
+			//  num : 0̏ꍇ̓n[hEFÃXbhijB1̏ꍇ͌ĂяoXbĥ݂ŏXbhȂ
+			void setThreadNum( uint32_t num );
+
+			// Xbh擾
+			//  0̏ꍇ̓n[hEFÃXbhԂ
+			uint32_t getThreadNum() const;
+
+			// ^C̕ӂ̃eNZݒ
+			//  size : 32
+			void setTileSize( uint32_t size );
+
+			// č\p[^ݒ
+			//  ߂l : p[^Ȃꍇfalse
+			bool setResult( const Result &res );
+
+			// o̖͐
+			//  origin_1spitch_oCg̕тŏށBNXȂǂ̉摜̈ꕔ𒼐ڎwł
+			struct FaceTarget {
+				uint8_t *origin_ = 0;	// ʂ̍̃eNZ
+				uint64_t pitch_ = 0;	// 1s̃oCg
+				bool rotated_ = false;	// true180x]ďށicNXZ-Ȃǁj
+			};
+
+			// 6ʂč\
+			//  width   : ʂ̃eNZ
+			//  format  : o͂̃sNZtH[}bgBRowEncoder̂tH[}bgł邱
+			//  targets : 6ʂ̏o͐
+			//  proc    : iBĂяoXbh^CɊeNZŌĂ
+			//  ߂l  : ΉĂȂtH[}bg̏ꍇfalse
+			bool reconstruct( uint32_t width, const ImageBlock::PixelFormat &format, const FaceTarget *targets, const std::function< void( uint64_t count, uint64_t procCount ) > &proc );
+
+			// 6ʂ̉摜ɍč\
+			//  faces : o͐6ʁBƃtH[}bg̐`ł邱
+			bool reconstruct( ImageBlock *faces, const std::function< void( uint64_t count, uint64_t procCount ) > &proc );
+
+			// ~}@iܓxoxj̉摜ɍč\
+			//   = atan2(z, x)0`2΁Ac = acos(y)0`΁i[Y+j
+			//  sɌoxɈ˂ȂiWh֐ƌW̐Ϙajmɂ1x߁A
+			//  scos(m)Asin(m)̘aClenshaw̑QōBO(HEL^2 + WEHEL)
+			//  image : o͐BRowEncoder̂tH[}bgł邱
+			//  proc  : iBĂяoXbhs܂Ƃ߂ĊeNZŌĂ
+			bool reconstructEquirect( ImageBlock &image, const std::function< void( uint64_t count, uint64_t procCount ) > &proc );
+
+			// ̒lZo
+			//  x, y, z : num̒PʃxNg
+			//  rgba    : num * 4̏o͐BjAȒlŁA̒l0ɃNvAAt@1
+			//  batchSize_gĂяoXbhŏBReconstructor𕡐̃XbhĂ΂Ȃ
+			void evaluate( const double *x, const double *y, const double *z, uint64_t num, float *rgba );
+
+			// ͂Ƃ̌덷
+			//  덷͗̊pi}XNꍇ͂̏d݂jŏdݕt
+			struct ErrorMetrics {
+				double rmse_ = 0.0;				// RGBRMSE
+				double channelRmse_[ 3 ] = {};	// FRMSE
+				double faceRmse_[ 6 ] = {};		// ʖRGBRMSE
+				double maxError_ = 0.0;			// ̐Ό덷̍ől
+				double peak_ = 0.0;				// PSNR̃s[Nl
+				double psnr_ = 0.0;				// PSNR(dB)B덷0̏ꍇ͖
+			};
+
+			// ͂̃L[u}bvƂ̌덷Zo
+			//  č\Ɣr𓯂pXōsA͂̍sPʂɃXbhŕSBt@Cɂ͉oȂ
+			//  cube     : ́BgetRow̃jAlƔrigetRow͕̃XbhĂԁjBd0̃eNZ͏
+			//  peak     : PSNR̃s[NlB0ȉ̏ꍇ͓͂̐̍ől
+			//  heatmaps : 0łȂꍇAʖ̌덷摜6BeNZRGB̓덷̕ς̕iF321`lj
+			//  č\l͏o͉摜Ɠ̒l0ɃNvĂr
+			bool measureError( const CubeData *cube, double peak, ErrorMetrics &metrics, std::vector< ImageBlock > *heatmaps, const std::function< void( uint64_t count, uint64_t procCount ) > &proc );
+
+		private:
+			// Xbh̍Ɨ̈
+			struct Scratch {
+				Buffer< double > basis_;	// l ( level + 1 )^2 * batchSize_g
+				Buffer< double > lane_;		// 1̊lia֐pj
+				Buffer< float > rgba_;		// ^C̍sRGBA
+				Buffer< double > ring_;		// s̐Fcos(m)Asin(m)̌W 6 * ( level + 1 )
+				Buffer< float > input_;		// 덷Zo̓͂̍sRGBA
+				double errorSum_[ 6 ][ 3 ];	// 덷Zo̖ʁAF̏dݕt덷̘a
+				double weightSum_[ 6 ];		// 덷Zo̖ʖ̏d݂̘a
+				double maxError_;			// 덷Zo̐̐Ό덷̍ől
+				double maxValue_;			// 덷Zo̓͂̐̍ől
+			};
+
+			// ^C
+			struct Tile {
+				uint32_t face_;
+				uint32_t u_;
+				uint32_t v_;
+				uint32_t w_;
+				uint32_t h_;
+			};
+
+			// ob`̊̕l]
+			//  x, y, z : batchSize_g̒PʃxNg
+			void evalBatch( const double *x, const double *y, const double *z, Scratch &scratch ) const;
+
+			// ob`̒̕lZo
+			//  rgba : num
+			void evalColors( const double *x, const double *y, const double *z, uint32_t num, float *rgba, Scratch &scratch ) const;
+
+			// ^C
+			void processTile( const Tile &tile, uint32_t width, const ImageBlock::PixelFormat &format, ImageUtil::RowEncoder encoder, const FaceTarget &target, Scratch &scratch ) const;
+
+			// ԍ^C擾
+			Tile getTile( uint64_t idx, uint32_t width ) const;
+
+			// 덷Zo1s
+			void processErrorRow( const CubeData *cube, uint32_t face, uint32_t v, std::vector< ImageBlock > *heatmaps, Scratch &scratch ) const;
+
+			// ~}@1s
+			void processEquirectRow( uint32_t v, ImageBlock &image, ImageUtil::RowEncoder encoder, Scratch &scratch ) const;
+
+			// Xbh̍Ɨ̈p
+			//  Ȃꍇ̂݊mۂ
+			void prepareScratch( uint32_t threadNum, uint64_t rgbaNum );
+
+			// ^XNĂяoXbhƍ쐬XbhŕSď
+			//  task : ( ԍ, Ɨ̈ )Ń^XNAeNZԂ
+			template< class Task >
+			void dispatch( uint64_t taskNum, uint32_t threadNum, uint64_t procCount, const Task &task, const std::function< void( uint64_t count, uint64_t procCount ) > &proc );
+
+			uint32_t threadNum_ = 0;
+			uint32_t tileSize_ = 32;
+			uint32_t level_ = 0;
+			uint32_t fnum_ = 0;
+			BasisType basis_ = BasisType_SH;
+			Buffer< double > coefs_;		// F̌W 3 * fnum_
+			Buffer< double > norm_;			// ʒa֐̐KW ( level + 1 )^2
+			std::vector< Scratch > scratch_;	// Xbh̍Ɨ̈
+			Buffer< double > phi_;			// ~}@̗񖈂cos()Asin()
+		};
+
+		// ~bv`F[t̃L[u}bv
+		//  ~bv0jAȕ_ōč\Aʂ̃~bv2x2eNZ𗧑̊pŏdݕtςč
+		//  S~bv̖ʂ1̃obt@DDSƓсiʖɃ~bv0珇jŋl߂ĕێ
+		class CubeMipChain {
+		public:
+			CubeMipChain() {}
+			~CubeMipChain() {}
+
+			// 쐬
+			//  width  : ~bv0̖ʂ̃eNZ
+			//  mipNum : ~bvB0̏ꍇ1x1܂őSāB1x1܂ł̐𒴂ꍇ͐؂l߂
+			//  format : o͂̃sNZtH[}bgBRowEncoder̂tH[}bgł邱
+			//  proc   : ~bv0̍č\̐i
+			//  TCYƃtH[}bgŌJԂꍇA2ڈȍ~͊mۂsȂiXbh1̏ꍇj
+			Error create( const Result &res, uint32_t width, uint32_t mipNum, const ImageBlock::PixelFormat &format, const std::function< void( uint64_t count, uint64_t procCount ) > &proc );
+
+			// č\̃Xbhݒ
+			//  num : 0̏ꍇ̓n[hEFÃXbhij
+			void setThreadNum( uint32_t num );
+
+			// ~bv擾
+			uint32_t getMipNum() const;
+
+			// ʂ̃eNZ擾
+			uint32_t getTexelSize( uint32_t mip = 0 ) const;
+
+			// sNZtH[}bg擾
+			const ImageBlock::PixelFormat &getPixelFormat() const;
+
+			// 1ʕ̉摜擾
+			//  obt@QƂImageBlockRefBCubeMipChaingI܂ŗL
+			ImageBlock getFace( uint32_t mip, uint32_t face ) const;
+
+			// S~bṽf[^擾
+			const uint8_t *data() const;
+			uint64_t size() const;
+
+			// DDSŕۑ
+			Error saveDDS( const char *filePath ) const;
+
+		private:
+			// ̊pŏdݕt1/2ɏk
+			//  src : width * width * 4RGBAi6ʕj
+			//  dest : ( width / 2 ) ^ 2 * 4RGBAi6ʕj
+			static void downsample( const float *src, uint32_t width, float *dest );
+
+			uint32_t width_ = 0;
+			uint32_t mipNum_ = 0;
+			ImageBlock::PixelFormat format_;
+			Buffer< uint8_t > data_;		// S~bv̖
+			uint64_t dataSize_ = 0;
+			std::vector< uint64_t > offsets_;	//  * mipNum_ + ~bṽoCgʒu
+			Buffer< float > linear_[ 2 ];	// jARGBÃ~bvi݂Ɏgj
+			Buffer< float > row_;			// GR[hs
+			Reconstructor reconstructor_;
+		};
+	}
+}
+
+#endif
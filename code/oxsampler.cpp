@@ -0,0 +1,199 @@
+#include "oxsampler.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+namespace OX {
+	namespace SphericalHarmonics {
+
+		// 
+		Error Sampler::initialize( const Result &res, uint32_t width, uint32_t tileSize, uint64_t maxCacheBytes ) {
+			if ( width == 0 || tileSize == 0 )
+				return Error( "invalid sampler size." );
+			reconstructor_.setThreadNum( 1 );
+			if ( reconstructor_.setResult( res ) == false )
+				return Error( "parameters are not enough for the level." );
+
+			width_ = width;
+			tileSize_ = tileSize;
+			tileNum_ = ( width + tileSize - 1 ) / tileSize;
+			const uint64_t stride = tileSize + 2;
+			const uint64_t tileBytes = stride * stride * 3 * sizeof( float );
+			maxTileNum_ = ( maxCacheBytes / tileBytes > 0 ? maxCacheBytes / tileBytes : 1 );
+			clearCache();
+			dirs_.resize( stride * 3 );
+			rgba_.resize( stride * 4 );
+			stat_ = Statistics();
+			return Error();
+		}
+
+		// w̒l擾
+		//  ̍ő听̎ŖʂIсAʏUVʒũeNZS̊ԂԂ
+		void Sampler::sample( double x, double y, double z, float *rgb ) {
+			stat_.sampleNum_++;
+			const double ax = fabs( x ), ay = fabs( y ), az = fabs( z );
+			CubeData::Face face;
+			if ( ax >= ay && ax >= az )
+				face = ( x >= 0.0 ? CubeData::PX : CubeData::NX );
+			else if ( ay >= az )
+				face = ( y >= 0.0 ? CubeData::PY : CubeData::NY );
+			else
+				face = ( z >= 0.0 ? CubeData::PZ : CubeData::NZ );
+			double axis[ 3 ], du[ 3 ], dv[ 3 ];
+			CubeData::getFaceBasis( face, axis, du, dv );
+			const double d = x * axis[ 0 ] + y * axis[ 1 ] + z * axis[ 2 ];
+			if ( width_ == 0 || d <= 0.0 ) {
+				rgb[ 0 ] = rgb[ 1 ] = rgb[ 2 ] = 0.0f;
+				return;
+			}
+			const double s = ( x * du[ 0 ] + y * du[ 1 ] + z * du[ 2 ] ) / d;
+			const double t = ( x * dv[ 0 ] + y * dv[ 1 ] + z * dv[ 2 ] ) / d;
+
+			// eNZS𐮐Ƃʒui-0.5`width_ - 0.5j
+			const double fu = ( s + 1.0 ) * 0.5 * width_ - 0.5;
+			const double fv = ( t + 1.0 ) * 0.5 * width_ - 0.5;
+			const int32_t iu = (int32_t)floor( fu );
+			const int32_t iv = (int32_t)floor( fv );
+			const int32_t last = (int32_t)width_ - 1;
+			const uint32_t tx = (uint32_t)( iu < 0 ? 0 : ( iu > last ? last : iu ) ) / tileSize_;
+			const uint32_t ty = (uint32_t)( iv < 0 ? 0 : ( iv > last ? last : iv ) ) / tileSize_;
+			const float *tile = getTile( face, tx, ty );
+
+			// 1eNZ炵^C̈ʒu
+			const uint32_t stride = tileSize_ + 2;
+			const uint32_t lu = (uint32_t)( iu - (int32_t)( tx * tileSize_ ) + 1 );
+			const uint32_t lv = (uint32_t)( iv - (int32_t)( ty * tileSize_ ) + 1 );
+			const float wu = (float)( fu - iu );
+			const float wv = (float)( fv - iv );
+			const float *p00 = tile + ( (uint64_t)lv * stride + lu ) * 3;
+			const float *p01 = p00 + 3;
+			const float *p10 = p00 + stride * 3;
+			const float *p11 = p10 + 3;
+			for ( int c = 0; c < 3; ++c ) {
+				const float top = p00[ c ] + ( p01[ c ] - p00[ c ] ) * wu;
+				const float bottom = p10[ c ] + ( p11[ c ] - p10[ c ] ) * wu;
+				rgb[ c ] = top + ( bottom - top ) * wv;
+			}
+		}
+
+		// ̒̕l擾
+		void Sampler::sample( const double *dirs, uint64_t num, float *rgb ) {
+			for ( uint64_t i = 0; i < num; ++i )
+				sample( dirs[ i * 3 ], dirs[ i * 3 + 1 ], dirs[ i * 3 + 2 ], rgb + i * 3 );
+		}
+
+		// z̃L[u}bṽeNZl擾
+		void Sampler::getTexels( CubeData::Face face, uint32_t u, uint32_t v, uint32_t w, uint32_t h, float *rgb ) {
+			if ( u + w > width_ || v + h > width_ )
+				return;
+			const uint32_t stride = tileSize_ + 2;
+			for ( uint32_t j = 0; j < h; ++j ) {
+				const uint32_t tv = v + j;
+				const uint32_t ty = tv / tileSize_;
+				for ( uint32_t i = 0; i < w; ) {
+					// ^C̘AeNZ܂Ƃ߂ĕ
+					const uint32_t tu = u + i;
+					const uint32_t tx = tu / tileSize_;
+					const uint32_t lu = tu - tx * tileSize_;
+					const uint32_t num = std::min( w - i, tileSize_ - lu );
+					const float *tile = getTile( face, tx, ty );
+					const float *src = tile + ( (uint64_t)( tv - ty * tileSize_ + 1 ) * stride + lu + 1 ) * 3;
+					memcpy( rgb + ( (uint64_t)j * w + i ) * 3, src, (uint64_t)num * 3 * sizeof( float ) );
+					i += num;
+				}
+			}
+		}
+
+		// LbVg킸Ɏw̒lZo
+		void Sampler::evaluate( double x, double y, double z, float *rgb ) {
+			const double l = sqrt( x * x + y * y + z * z );
+			if ( width_ == 0 || l <= 0.0 ) {
+				rgb[ 0 ] = rgb[ 1 ] = rgb[ 2 ] = 0.0f;
+				return;
+			}
+			x /= l;
+			y /= l;
+			z /= l;
+			float rgba[ 4 ];
+			reconstructor_.evaluate( &x, &y, &z, 1, rgba );
+			rgb[ 0 ] = rgba[ 0 ];
+			rgb[ 1 ] = rgba[ 1 ];
+			rgb[ 2 ] = rgba[ 2 ];
+		}
+
+		// LbVj
+		void Sampler::clearCache() {
+			tiles_.clear();
+			index_.clear();
+			stat_.cachedBytes_ = 0;
+		}
+
+		// v擾
+		const Sampler::Statistics &Sampler::getStatistics() const {
+			return stat_;
+		}
+
+		// ^C擾
+		//  LbVt̏ꍇ͍łgĂȂ^C̗̈g
+		const float *Sampler::getTile( uint32_t face, uint32_t tx, uint32_t ty ) {
+			const uint64_t key = ( (uint64_t)face * tileNum_ + ty ) * tileNum_ + tx;
+			auto it = index_.find( key );
+			if ( it != index_.end() ) {
+				stat_.hitNum_++;
+				tiles_.splice( tiles_.begin(), tiles_, it->second );
+				return tiles_.front().rgb_.data();
+			}
+
+			stat_.missNum_++;
+			if ( tiles_.size() >= maxTileNum_ ) {
+				tiles_.splice( tiles_.begin(), tiles_, std::prev( tiles_.end() ) );
+				index_.erase( tiles_.front().key_ );
+				stat_.evictNum_++;
+			} else {
+				const uint64_t stride = tileSize_ + 2;
+				tiles_.emplace_front();
+				tiles_.front().rgb_.resize( stride * stride * 3 );
+				stat_.cachedBytes_ += stride * stride * 3 * sizeof( float );
+			}
+			Tile &tile = tiles_.front();
+			tile.key_ = key;
+			buildTile( face, tx, ty, tile.rgb_.data() );
+			index_[ key ] = tiles_.begin();
+			return tile.rgb_.data();
+		}
+
+		// ^Cč\
+		//  1eNZ͖ʂ̕ʂŋ߂
+		void Sampler::buildTile( uint32_t face, uint32_t tx, uint32_t ty, float *rgb ) {
+			const uint32_t stride = tileSize_ + 2;
+			double axis[ 3 ], du[ 3 ], dv[ 3 ];
+			CubeData::getFaceBasis( (CubeData::Face)face, axis, du, dv );
+			double *x = dirs_.data();
+			double *y = x + stride;
+			double *z = y + stride;
+			float *rgba = rgba_.data();
+			for ( uint32_t j = 0; j < stride; ++j ) {
+				const int32_t tv = (int32_t)( ty * tileSize_ + j ) - 1;
+				const double t = ( 2.0 * tv + 1.0 ) / width_ - 1.0;
+				for ( uint32_t i = 0; i < stride; ++i ) {
+					const int32_t tu = (int32_t)( tx * tileSize_ + i ) - 1;
+					const double s = ( 2.0 * tu + 1.0 ) / width_ - 1.0;
+					const double dx = axis[ 0 ] + s * du[ 0 ] + t * dv[ 0 ];
+					const double dy = axis[ 1 ] + s * du[ 1 ] + t * dv[ 1 ];
+					const double dz = axis[ 2 ] + s * du[ 2 ] + t * dv[ 2 ];
+					const double il = 1.0 / sqrt( dx * dx + dy * dy + dz * dz );
+					x[ i ] = dx * il;
+					y[ i ] = dy * il;
+					z[ i ] = dz * il;
+				}
+				reconstructor_.evaluate( x, y, z, stride, rgba );
+				float *dest = rgb + (uint64_t)j * stride * 3;
+				for ( uint32_t i = 0; i < stride; ++i ) {
+					dest[ i * 3 + 0 ] = rgba[ i * 4 + 0 ];
+					dest[ i * 3 + 1 ] = rgba[ i * 4 + 1 ];
+					dest[ i * 3 + 2 ] = rgba[ i * 4 + 2 ];
+				}
+			}
+		}
+	}
+}
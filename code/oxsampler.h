@@ -0,0 +1,90 @@
+#ifndef __ox_oxsampler_h__
+#define __ox_oxsampler_h__
+
+// p[^̒xTvO
+
+#include <list>
+#include <unordered_map>
+#include "oxreconstructor.h"
+
+namespace OX {
+	namespace SphericalHarmonics {
+
+		// p[^̒xTv[
+		//  L[u}bvŜ͍炸Avꂽ܂ޖʂ̃^Cč\ăLbV
+		//  ^C͎1eNZ܂߂čč\̂ŁAoCjAԂ̓^CŊ
+		//  LbV͏̃oCg𒴂ƍłgĂȂ^CjiLRUj
+		//  XbhZ[tł͂ȂBXbhɕʂ̃Tv[g
+		class Sampler {
+		public:
+			// v
+			struct Statistics {
+				uint64_t sampleNum_ = 0;	// Tv
+				uint64_t hitNum_ = 0;		// LbVɂ^C̎QƐ
+				uint64_t missNum_ = 0;		// č\^C
+				uint64_t evictNum_ = 0;		// j^C
+				uint64_t cachedBytes_ = 0;	// LbṼoCg
+			};
+
+			Sampler() {}
+			~Sampler() {}
+
+			// 
+			//  width         : z̃L[u}bv̖ʂ̃eNZBԂׂ̍ɂȂ
+			//  tileSize      : ^C̕ӂ̃eNZ
+			//  maxCacheBytes : LbV̍őoCgB1^C菬ꍇ1^C͕ێ
+			Error initialize( const Result &res, uint32_t width, uint32_t tileSize = 32, uint64_t maxCacheBytes = 16ull * 1024 * 1024 );
+
+			// w̒l擾
+			//  x, y, z : iKsvj
+			//  rgb     : jARGBBLbV^CoCjAԂ
+			void sample( double x, double y, double z, float *rgb );
+
+			// ̒̕l擾
+			//  dirs : num * 3̕(x, y, z)
+			//  rgb  : num * 3̏o͐
+			void sample( const double *dirs, uint64_t num, float *rgb );
+
+			// z̃L[u}bṽeNZl擾
+			//  u, v, w, h : ʓ̋`̈
+			//  rgb        : w * h * 3̏o͐
+			void getTexels( CubeData::Face face, uint32_t u, uint32_t v, uint32_t w, uint32_t h, float *rgb );
+
+			// LbVg킸Ɏw̒lZo
+			void evaluate( double x, double y, double z, float *rgb );
+
+			// LbVj
+			void clearCache();
+
+			// v擾
+			const Statistics &getStatistics() const;
+
+		private:
+			// LbV^C
+			struct Tile {
+				uint64_t key_ = 0;
+				Buffer< float > rgb_;	// ( tileSize_ + 2 )^2 * 3̒lB1eNZ܂
+			};
+
+			// ^C擾
+			//  LbVɖꍇ͍č\B擾^C͍łVĝɂȂ
+			const float *getTile( uint32_t face, uint32_t tx, uint32_t ty );
+
+			// ^Cč\
+			void buildTile( uint32_t face, uint32_t tx, uint32_t ty, float *rgb );
+
+			Reconstructor reconstructor_;
+			uint32_t width_ = 0;
+			uint32_t tileSize_ = 32;
+			uint32_t tileNum_ = 0;			// ʂ1ӂ̃^C
+			uint64_t maxTileNum_ = 0;		// LbV^C̏
+			std::list< Tile > tiles_;		// Vg
+			std::unordered_map< uint64_t, std::list< Tile >::iterator > index_;
+			Buffer< double > dirs_;			// ^C̕ 3 * ( tileSize_ + 2 )
+			Buffer< float > rgba_;			// ^C1sRGBA
+			Statistics stat_;
+		};
+	}
+}
+
+#endif
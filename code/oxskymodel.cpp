@@ -0,0 +1,191 @@
+#include "oxskymodel.h"
+#include <math.h>
+
+namespace OX {
+	namespace {
+		const double pi_g = 3.14159265358979323846;
+
+		// Perez֐
+		double perez( const double *c, double cosTh, double gamma, double cosGamma ) {
+			return ( 1.0 + c[ 0 ] * exp( c[ 1 ] / cosTh ) ) * ( 1.0 + c[ 2 ] * exp( c[ 3 ] * gamma ) + c[ 4 ] * cosGamma * cosGamma );
+		}
+
+		// Yxylinear sRGBɕϊ
+		void yxyToRGB( double Y, double x, double y, double &r, double &g, double &b ) {
+			double X = ( y > 0.0 ? x * Y / y : 0.0 );
+			double Z = ( y > 0.0 ? ( 1.0 - x - y ) * Y / y : 0.0 );
+			r =  3.2406 * X - 1.5372 * Y - 0.4986 * Z;
+			g = -0.9689 * X + 1.8758 * Y + 0.0415 * Z;
+			b =  0.0557 * X - 0.2040 * Y + 1.0570 * Z;
+		}
+	}
+
+	namespace SphericalHarmonics {
+
+		PreethamSkyData::PreethamSkyData( double sunTh, double sunPhi, double turbidity, double groundAlbedo, double scale ) : scale_( scale ) {
+			const double T = turbidity;
+			const double ts = ( sunTh < 0.0 ? 0.0 : ( sunTh > pi_g * 0.5 ? pi_g * 0.5 : sunTh ) );
+			sunX_ = sin( ts ) * cos( sunPhi );
+			sunY_ = cos( ts );
+			sunZ_ = sin( ts ) * sin( sunPhi );
+
+			// Perez֐̌W
+			const double cY[ 5 ] = { 0.1787 * T - 1.4630, -0.3554 * T + 0.4275, -0.0227 * T + 5.3251, 0.1206 * T - 2.5771, -0.0670 * T + 0.3703 };
+			const double cx[ 5 ] = { -0.0193 * T - 0.2592, -0.0665 * T + 0.0008, -0.0004 * T + 0.2125, -0.0641 * T - 0.8989, -0.0033 * T + 0.0452 };
+			const double cy[ 5 ] = { -0.0167 * T - 0.2608, -0.0950 * T + 0.0092, -0.0079 * T + 0.2102, -0.0441 * T - 1.6537, -0.0109 * T + 0.0529 };
+			for ( int i = 0; i < 5; ++i ) {
+				perezY_[ i ] = cY[ i ];
+				perezx_[ i ] = cx[ i ];
+				perezy_[ i ] = cy[ i ];
+			}
+
+			// VYxy
+			const double chi = ( 4.0 / 9.0 - T / 120.0 ) * ( pi_g - 2.0 * ts );
+			const double Yz = ( 4.0453 * T - 4.9710 ) * tan( chi ) - 0.2155 * T + 2.4192;
+			const double ts2 = ts * ts, ts3 = ts2 * ts;
+			const double xz =
+				T * T * ( 0.00166 * ts3 - 0.00375 * ts2 + 0.00209 * ts ) +
+				T * ( -0.02903 * ts3 + 0.06377 * ts2 - 0.03202 * ts + 0.00394 ) +
+				( 0.11693 * ts3 - 0.21196 * ts2 + 0.06052 * ts + 0.25886 );
+			const double yz =
+				T * T * ( 0.00275 * ts3 - 0.00610 * ts2 + 0.00317 * ts ) +
+				T * ( -0.04214 * ts3 + 0.08970 * ts2 - 0.04153 * ts + 0.00516 ) +
+				( 0.15346 * ts3 - 0.26756 * ts2 + 0.06670 * ts + 0.26688 );
+			const double cosTs = cos( ts );
+			zenithY_ = Yz / perez( perezY_, 1.0, ts, cosTs );
+			zenithx_ = xz / perez( perezx_, 1.0, ts, cosTs );
+			zenithy_ = yz / perez( perezy_, 1.0, ts, cosTs );
+
+			// nʂ̋Px͋̐ʏƓxAxhŊgU˂
+			const uint32_t muNum = 16, phiNum = 32;
+			double er = 0.0, eg = 0.0, eb = 0.0;
+			for ( uint32_t i = 0; i < muNum; ++i ) {
+				const double mu = ( i + 0.5 ) / muNum;
+				const double sinTh = sqrt( 1.0 - mu * mu );
+				for ( uint32_t j = 0; j < phiNum; ++j ) {
+					const double phi = 2.0 * pi_g * ( j + 0.5 ) / phiNum;
+					const double cosGamma = sinTh * cos( phi ) * sunX_ + mu * sunY_ + sinTh * sin( phi ) * sunZ_;
+					double Y, x, y, r, g, b;
+					getSkyYxy( mu, cosGamma, Y, x, y );
+					yxyToRGB( Y, x, y, r, g, b );
+					er += r * mu;
+					eg += g * mu;
+					eb += b * mu;
+				}
+			}
+			const double dw = ( 1.0 / muNum ) * ( 2.0 * pi_g / phiNum );
+			groundR_ = groundAlbedo * er * dw / pi_g;
+			groundG_ = groundAlbedo * eg * dw / pi_g;
+			groundB_ = groundAlbedo * eb * dw / pi_g;
+		}
+
+		// injYxy擾
+		void PreethamSkyData::getSkyYxy( double cosTh, double cosGamma, double &Y, double &x, double &y ) const {
+			cosTh = ( cosTh < 0.01 ? 0.01 : cosTh );
+			cosGamma = ( cosGamma < -1.0 ? -1.0 : ( cosGamma > 1.0 ? 1.0 : cosGamma ) );
+			const double gamma = acos( cosGamma );
+			Y = zenithY_ * perez( perezY_, cosTh, gamma, cosGamma );
+			x = zenithx_ * perez( perezx_, cosTh, gamma, cosGamma );
+			y = zenithy_ * perez( perezy_, cosTh, gamma, cosGamma );
+		}
+
+		// ẘpxɑ΂Px擾
+		double PreethamSkyData::getValue( double th, double phi ) const {
+			const double cosTh = cos( th );
+			if ( cosTh < 0.0 )
+				return ( 0.2126 * groundR_ + 0.7152 * groundG_ + 0.0722 * groundB_ ) * scale_;
+			const double sinTh = sin( th );
+			const double cosGamma = sinTh * cos( phi ) * sunX_ + cosTh * sunY_ + sinTh * sin( phi ) * sunZ_;
+			double Y, x, y;
+			getSkyYxy( cosTh, cosGamma, Y, x, y );
+			return Y * scale_;
+		}
+
+		// ẘpxɑ΂RGBl擾
+		void PreethamSkyData::getRGB( double th, double phi, double &r, double &g, double &b ) const {
+			const double cosTh = cos( th );
+			if ( cosTh < 0.0 ) {
+				r = groundR_ * scale_;
+				g = groundG_ * scale_;
+				b = groundB_ * scale_;
+				return;
+			}
+			const double sinTh = sin( th );
+			const double cosGamma = sinTh * cos( phi ) * sunX_ + cosTh * sunY_ + sinTh * sin( phi ) * sunZ_;
+			double Y, x, y;
+			getSkyYxy( cosTh, cosGamma, Y, x, y );
+			yxyToRGB( Y * scale_, x, y, r, g, b );
+		}
+
+
+
+		// e[u쐬
+		Error SkyTable::create( uint32_t elevationNum, double turbidity, double groundAlbedo, double scale, SphereEstimater &estimater ) {
+			if ( elevationNum < 2 )
+				return Error( "elevationNum must be 2 or more." );
+
+			const uint32_t level = estimater.getMaxLevel();
+			const uint32_t fnum = ( level + 1 ) * ( level + 1 );
+			std::vector< double > coefs( elevationNum * 3 * fnum );
+			for ( uint32_t e = 0; e < elevationNum; ++e ) {
+				const double sunTh = 0.5 * pi_g * e / ( elevationNum - 1 );
+				PreethamSkyData sky( sunTh, 0.0, turbidity, groundAlbedo, scale );
+				Result res;
+				Error err = estimater.estimate( &sky, res );
+				if ( err.error_ )
+					return err;
+				for ( uint32_t c = 0; c < 3; ++c ) {
+					const auto params = res.getCoefs( (ColorType)c );
+					for ( uint32_t f = 0; f < fnum; ++f )
+						coefs[ ( e * 3 + c ) * fnum + f ] = params[ f ];
+				}
+			}
+			maxLevel_ = level;
+			elevationNum_ = elevationNum;
+			coefs_.swap( coefs );
+			return Error();
+		}
+
+		// zɑ΂p[^擾
+		Error SkyTable::getResult( double sunTh, double sunPhi, Result &res ) const {
+			if ( elevationNum_ == 0 )
+				return Error( "sky table is not created." );
+
+			// zxŐ`
+			double t = sunTh / ( 0.5 * pi_g ) * ( elevationNum_ - 1 );
+			t = ( t < 0.0 ? 0.0 : ( t > elevationNum_ - 1 ? elevationNum_ - 1 : t ) );
+			uint32_t e0 = (uint32_t)t;
+			uint32_t e1 = ( e0 + 1 < elevationNum_ ? e0 + 1 : e0 );
+			double a = t - e0;
+
+			// YsunPhi]
+			//  cos(m)sin(m)̌W̑g2]
+			const uint32_t fnum = ( maxLevel_ + 1 ) * ( maxLevel_ + 1 );
+			std::vector< double > coefs( 3 * fnum );
+			for ( uint32_t c = 0; c < 3; ++c ) {
+				const double *c0 = &coefs_[ ( e0 * 3 + c ) * fnum ];
+				const double *c1 = &coefs_[ ( e1 * 3 + c ) * fnum ];
+				double *v = &coefs[ c * fnum ];
+				for ( uint32_t f = 0; f < fnum; ++f )
+					v[ f ] = c0[ f ] * ( 1.0 - a ) + c1[ f ] * a;
+				for ( uint32_t l = 1; l <= maxLevel_; ++l ) {
+					for ( int32_t m = 1; m <= (int32_t)l; ++m ) {
+						const uint32_t pidx = Parameter::toIdx( l, m );
+						const uint32_t nidx = Parameter::toIdx( l, -m );
+						const double cs = cos( m * sunPhi ), sn = sin( m * sunPhi );
+						const double pv = v[ pidx ], nv = v[ nidx ];
+						v[ pidx ] = pv * cs - nv * sn;
+						v[ nidx ] = pv * sn + nv * cs;
+					}
+				}
+			}
+			res.set( maxLevel_, &coefs[ 0 ], &coefs[ fnum ], &coefs[ fnum * 2 ], 1.0 );
+			return Error();
+		}
+
+		// band order level̍ől擾
+		uint32_t SkyTable::getMaxLevel() const {
+			return maxLevel_;
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#ifndef __ox_oxskymodel_h__
+#define __ox_oxskymodel_h__
+
+// ͓Iȋ󃂃f
+
+#include "oxsphericalharmonics.h"
+
+namespace OX {
+	namespace SphericalHarmonics {
+
+		// Preethamfɂ̋ʃf[^
+		//  VY+ith = 0jBn艺͒nʂ̃AxhŔ˂lȋPxƂ
+		//  lCIE Yikcd/m^2jlinear sRGBɕϊ̂scale|
+		class PreethamSkyData : public SphereData {
+		public:
+			//  sunTh        : z̈ܓxp(0`/2)
+			//  sunPhi       : žoxp(0`2)
+			//  turbidity    : C̍x(2`10x)
+			//  groundAlbedo : nʂ̃Axh(0`1)
+			//  scale        : PxɊ|W
+			PreethamSkyData( double sunTh, double sunPhi, double turbidity, double groundAlbedo, double scale = 1.0 );
+			virtual ~PreethamSkyData() {}
+
+			// ẘpxɑ΂Px擾
+			virtual double getValue( double th, double phi ) const override;
+
+			// ẘpxɑ΂RGBl擾
+			virtual void getRGB( double th, double phi, double &r, double &g, double &b ) const override;
+
+		private:
+			// injYxy擾
+			void getSkyYxy( double cosTh, double cosGamma, double &Y, double &x, double &y ) const;
+
+			double sunX_ = 0.0, sunY_ = 1.0, sunZ_ = 0.0;	// z
+			double perezY_[ 5 ], perezx_[ 5 ], perezy_[ 5 ];	// Perez֐̌W
+			double zenithY_ = 0.0, zenithx_ = 0.0, zenithy_ = 0.0;	// VYxyF(0, s)Ŋ
+			double groundR_ = 0.0, groundG_ = 0.0, groundB_ = 0.0;	// nʂ̋Px
+			double scale_ = 1.0;
+		};
+
+		// zx̋̃p[^e[u
+		//  žox = 0őzxɐ肵ĂA擾͍xŐ`ԂĂYɉ]
+		class SkyTable {
+		public:
+			SkyTable() {}
+			~SkyTable() {}
+
+			// e[u쐬
+			//  level        : band order level̍ől
+			//  elevationNum : zx(s = 0`/2)̕i2ȏj
+			//  estimater    : ex̐Ɏgiϓ_ݒς݂̂́j
+			Error create( uint32_t elevationNum, double turbidity, double groundAlbedo, double scale, SphereEstimater &estimater );
+
+			// zɑ΂p[^擾
+			//  sunTh  : z̈ܓxp(0`/2)B͈͊O̓Nv
+			//  sunPhi : žoxp(0`2)
+			Error getResult( double sunTh, double sunPhi, Result &res ) const;
+
+			// band order level̍ől擾
+			uint32_t getMaxLevel() const;
+
+		private:
+			uint32_t maxLevel_ = 0;
+			uint32_t elevationNum_ = 0;
+			std::vector< double > coefs_;	// x x F(RGB) x ֐
+		};
+	}
+}
+
+#endif
@@ -1,14 +1,78 @@
 #include "oxsphericalharmonics.h"
+#include "oxreconstructor.h"
 #include <math.h>
+#include <algorithm>
 #include <sstream>
 #include <fstream>
 #include <iomanip>
 
 namespace OX {
 	namespace {
-		double clamp( double v, double min, double max ) {
-			return ( v < min ? min : ( v > max ? max : v ) );
-		};
+		// }XN̏d݂0`1ɐ
+		//  _HDR̉摜͔͈͊O̒lBNaN0Ƃ
+		float clampWeight( float w ) {
+			return ( w > 0.0f ? ( w < 1.0f ? w : 1.0f ) : 0.0f );
+		}
+
+		// Ώ̐lsa(n x n)RXL[Opsɒu
+		//  ߂l : lłȂꍇfalse
+		bool choleskyDecompose( double *a, uint32_t n ) {
+			for ( uint32_t j = 0; j < n; ++j ) {
+				double d = a[ j * n + j ];
+				for ( uint32_t k = 0; k < j; ++k )
+					d -= a[ j * n + k ] * a[ j * n + k ];
+				if ( d <= 0.0 )
+					return false;
+				d = sqrt( d );
+				a[ j * n + j ] = d;
+				for ( uint32_t i = j + 1; i < n; ++i ) {
+					double v = a[ i * n + j ];
+					for ( uint32_t k = 0; k < j; ++k )
+						v -= a[ i * n + k ] * a[ j * n + k ];
+					a[ i * n + j ] = v / d;
+				}
+				for ( uint32_t i = j + 1; i < n; ++i )
+					a[ j * n + i ] = 0.0;
+			}
+			return true;
+		}
+
+		// RXL[ς݂̉OpslL y = bibyŒuj
+		//  y̐擪ml̐擪msŌ܂̂ŁA擪̃ubN̑Oi˂
+		void choleskyForward( const double *l, uint32_t n, double *b ) {
+			for ( uint32_t i = 0; i < n; ++i ) {
+				double v = b[ i ];
+				for ( uint32_t k = 0; k < i; ++k )
+					v -= l[ i * n + k ] * b[ k ];
+				b[ i ] = v / l[ i * n + i ];
+			}
+		}
+
+		// RXL[ς݂̉Opsl̐擪m x m̃ubNL^T x = yiyxŒuj
+		void choleskyBackward( const double *l, uint32_t n, uint32_t m, double *y ) {
+			for ( uint32_t i = m; i-- > 0; ) {
+				double v = y[ i ];
+				for ( uint32_t k = i + 1; k < m; ++k )
+					v -= l[ k * n + i ] * y[ k ];
+				y[ i ] = v / l[ i * n + i ];
+			}
+		}
+
+		// RXL[ς݂̉OpslL L^T x = bibxŒuj
+		void choleskySolve( const double *l, uint32_t n, double *b ) {
+			choleskyForward( l, n, b );
+			choleskyBackward( l, n, n, b );
+		}
+
+		// FNV-1anbV
+		uint64_t hashBytes( const void *data, size_t size, uint64_t h = 14695981039346656037ull ) {
+			const uint8_t *p = (const uint8_t*)data;
+			for ( size_t i = 0; i < size; ++i ) {
+				h ^= p[ i ];
+				h *= 1099511628211ull;
+			}
+			return h;
+		}
 	}
 
 	namespace SphericalHarmonics {
@@ -115,92 +179,258 @@ namespace OX {
 			return *ylist;
 		}
 
-		// p[^L[u}bv쐬
-		std::vector< ImageBlock > createCubeMapFromParameters( const Result &res, uint32_t width, CubeMapType mapType, const std::function< void( uint64_t count, uint64_t procCount ) > &proc ) {
-			uint32_t maxLevel = res.getMaxLevel();
-			const auto &paramR = res.getParamList( SphericalHarmonics::ColorType::ColorType_R );
-			const auto &paramG = res.getParamList( SphericalHarmonics::ColorType::ColorType_G );
-			const auto &paramB = res.getParamList( SphericalHarmonics::ColorType::ColorType_B );
-			std::vector< std::vector< Parameter > > params;
-			params.push_back( paramR );
-			params.push_back( paramG );
-			params.push_back( paramB );
-			auto yfuncs = createSphericalHarmonicsFuncs( res.getMaxLevel() );
-
-			ImageBlockCustom images[] = {
-				ImageBlockCustom( width, width, 3, 0 ),
-				ImageBlockCustom( width, width, 3, 0 ),
-				ImageBlockCustom( width, width, 3, 0 ),
-				ImageBlockCustom( width, width, 3, 0 ),
-				ImageBlockCustom( width, width, 3, 0 ),
-				ImageBlockCustom( width, width, 3, 0 ),
-			};
+		// w̋ʒa֐lSĎZo
+		//  sin^m(th) * cos(m * phi), sin^m(th) * sin(m * phi)  (x + iz)^m ƂċߎOp֐gȂ
+		void evalSphericalHarmonics( uint32_t level, double x, double y, double z, double *out ) {
+			// KWe[u
+			const uint32_t tableLevel = 32;
+			static const std::vector< double > normTable = [ tableLevel ]() {
+				std::vector< double > table( ( tableLevel + 1 ) * ( tableLevel + 1 ) );
+				for ( uint32_t l = 0; l <= tableLevel; ++l ) {
+					for ( uint32_t m = 0; m <= l; ++m ) {
+						double f = 1.0;
+						for ( uint32_t k = l - m + 1; k <= l + m; ++k )
+							f /= k;
+						double c = ( 2 * l + 1 ) / ( 4.0 * 3.14159265358979323846 ) * f;
+						table[ l * ( tableLevel + 1 ) + m ] = sqrt( m == 0 ? c : 2.0 * c );
+					}
+				}
+				return table;
+			}();
+
+			double cm = 1.0, sm = 0.0;	// (x + iz)^m̎A
+			double pmm = 1.0;			// P_m_m̑
+			for ( uint32_t m = 0; m <= level; ++m ) {
+				if ( m > 0 ) {
+					double c = cm * x - sm * z;
+					sm = cm * z + sm * x;
+					cm = c;
+					pmm *= -( 2.0 * m - 1.0 );
+				}
+				double p2 = 0.0, p1 = 0.0;
+				for ( uint32_t l = m; l <= level; ++l ) {
+					double p;
+					if ( l == m )
+						p = pmm;
+					else if ( l == m + 1 )
+						p = y * ( 2.0 * m + 1 ) * pmm;
+					else
+						p = ( y * ( 2.0 * l - 1 ) * p1 - ( l + m - 1 ) * p2 ) / ( l - m );
+					p2 = p1;
+					p1 = p;
+
+					double k;
+					if ( l <= tableLevel ) {
+						k = normTable[ l * ( tableLevel + 1 ) + m ];
+					} else {
+						double f = 1.0;
+						for ( uint32_t i = l - m + 1; i <= l + m; ++i )
+							f /= i;
+						double c = ( 2 * l + 1 ) / ( 4.0 * 3.14159265358979323846 ) * f;
+						k = sqrt( m == 0 ? c : 2.0 * c );
+					}
+					if ( m == 0 ) {
+						out[ Parameter::toIdx( l, 0 ) ] = k * p;
+					} else {
+						out[ Parameter::toIdx( l, m ) ] = k * p * cm;
+						out[ Parameter::toIdx( l, -(int32_t)m ) ] = k * p * sm;
+					}
+				}
+			}
+		}
 
-			uint64_t count = 0;
-			uint64_t procCount = width * width * CubeData::Face::Face_Num;
-			for ( uint32_t f = 0; f < CubeData::Face::Face_Num; ++f ) {
-				CubeData::Face face = ( CubeData::Face )f;
-				uint8_t *p = images[ f ].p();
-				for ( uint32_t tv = 0; tv < width; ++tv ) {
-					for ( uint32_t tu = 0; tu < width; ++tu ) {
-						double th, phi;
-						double l = CubeData::getPolar( face, width, tu, tv, th, phi );
-
-						// (tu, tv)ɑΉFZo
-						double r = 0.0, g = 0.0, b = 0.0;
-						for ( uint32_t y = 0; y < yfuncs.size(); ++y ) {
-							double yval = yfuncs[ y ]( th, phi );
-							r += paramR[ y ].value() * yval;
-							g += paramG[ y ].value() * yval;
-							b += paramB[ y ].value() * yval;
-						}
-						p[ 0 ] = (uint8_t)( clamp( r, 0.0, 1.0 ) * 255 );
-						p[ 1 ] = (uint8_t)( clamp( g, 0.0, 1.0 ) * 255 );
-						p[ 2 ] = (uint8_t)( clamp( b, 0.0, 1.0 ) * 255 );
-						p += 3;
-						proc( count, procCount );
-						count++;
+		void evalSphericalHarmonics( uint32_t level, double th, double phi, double *out ) {
+			double sinTh = sin( th );
+			evalSphericalHarmonics( level, sinTh * cos( phi ), cos( th ), sinTh * sin( phi ), out );
+		}
+
+		// w̔a֐lSĎZo
+		//  H_l_m = K_l_m * P_l_|m|(2cos(th) - 1) * cos(m * phi) (m < 0sin(|m| * phi))
+		//  K_l_m = sqrt((2 - _m0) * (2l + 1) / 2 * (l - |m|)! / (l + |m|)!)
+		void evalHemisphericalHarmonics( uint32_t level, double x, double y, double z, double *out ) {
+			const double t = 2.0 * y - 1.0;
+			const double st = sqrt( ( 1.0 - t ) * ( 1.0 + t ) > 0.0 ? ( 1.0 - t ) * ( 1.0 + t ) : 0.0 );
+
+			// ox̒Pʕf (x + iz) / |x + iz|
+			double s = sqrt( x * x + z * z );
+			double ex = ( s > 0.0 ? x / s : 1.0 );
+			double ez = ( s > 0.0 ? z / s : 0.0 );
+
+			double cm = 1.0, sm = 0.0;	// cos(m * phi), sin(m * phi)
+			double pmm = 1.0;			// P_m_m(t)
+			for ( uint32_t m = 0; m <= level; ++m ) {
+				if ( m > 0 ) {
+					double c = cm * ex - sm * ez;
+					sm = cm * ez + sm * ex;
+					cm = c;
+					pmm *= -( 2.0 * m - 1.0 ) * st;
+				}
+				double p2 = 0.0, p1 = 0.0;
+				for ( uint32_t l = m; l <= level; ++l ) {
+					double p;
+					if ( l == m )
+						p = pmm;
+					else if ( l == m + 1 )
+						p = t * ( 2.0 * m + 1 ) * pmm;
+					else
+						p = ( t * ( 2.0 * l - 1 ) * p1 - ( l + m - 1 ) * p2 ) / ( l - m );
+					p2 = p1;
+					p1 = p;
+
+					double f = 1.0;
+					for ( uint32_t i = l - m + 1; i <= l + m; ++i )
+						f /= i;
+					double k = sqrt( ( m == 0 ? 1.0 : 2.0 ) * ( 2 * l + 1 ) / ( 2.0 * 3.14159265358979323846 ) * f );
+					if ( m == 0 ) {
+						out[ Parameter::toIdx( l, 0 ) ] = k * p;
+					} else {
+						out[ Parameter::toIdx( l, m ) ] = k * p * cm;
+						out[ Parameter::toIdx( l, -(int32_t)m ) ] = k * p * sm;
 					}
 				}
 			}
+		}
+
+		// 茋ʂ̊Ŏẘ֐lSĎZo
+		void evalBasis( const Result &res, double x, double y, double z, double *out ) {
+			const uint32_t level = res.getMaxLevel();
+			if ( res.getBasisType() == BasisType_HSH ) {
+				if ( y < 0.0 ) {
+					for ( uint32_t i = 0; i < ( level + 1 ) * ( level + 1 ); ++i )
+						out[ i ] = 0.0;
+					return;
+				}
+				evalHemisphericalHarmonics( level, x, y, z, out );
+				return;
+			}
+			evalSphericalHarmonics( level, x, y, z, out );
+		}
 
-			std::vector< ImageBlock > outImageBlocks;
+		// p[^L[u}bv쐬
+		std::vector< ImageBlock > createCubeMapFromParameters( const Result &res, uint32_t width, CubeMapType mapType, const std::function< void( uint64_t count, uint64_t procCount ) > &proc, ImageBlock::ComponentType type, ImageBlock::ColorSpace colorSpace, float gamma ) {
+			Workspace workspace;
+			std::vector< ImageBlock > out;
+			if ( createCubeMapFromParameters( res, width, mapType, proc, workspace, out, type, colorSpace, gamma ) == false )
+				return std::vector< ImageBlock >();
+			return out;
+		}
 
+		// Ɨ̈Əo͐g񂵂ăL[u}bv쐬
+		bool createCubeMapFromParameters( const Result &res, uint32_t width, CubeMapType mapType, const std::function< void( uint64_t count, uint64_t procCount ) > &proc, Workspace &workspace, std::vector< ImageBlock > &out, ImageBlock::ComponentType type, ImageBlock::ColorSpace colorSpace, float gamma ) {
+			if ( workspace.reconstructor_ == nullptr )
+				workspace.reconstructor_ = std::make_shared< Reconstructor >();
+			Reconstructor &reconstructor = *workspace.reconstructor_;
+			reconstructor.setThreadNum( workspace.threadNum_ );
+			if ( reconstructor.setResult( res ) == false )
+				return false;
+
+			ImageBlock::PixelFormat format( 3, type, colorSpace );
+			format.gamma_ = gamma;
+			if ( ImageUtil::getRowEncoder( format ) == 0 )
+				return false;
+
+			// TCYƃtH[}bg̉摜͎g
+			auto reuse = [ &format ]( ImageBlock &image, uint32_t w, uint32_t h ) {
+				const ImageBlock::PixelFormat &f = image.format();
+				if ( image.isExist() && image.width() == w && image.height() == h &&
+					f.channelNum_ == format.channelNum_ && f.type_ == format.type_ && f.colorSpace_ == format.colorSpace_ && f.gamma_ == format.gamma_ &&
+					image.pitch() == (uint64_t)w * format.bytePerColor() )
+					return;
+				image = ImageBlockCustom( w, h, format, 0 );
+			};
+			// zű搔Ɩʖ̋̈ʒu
+			struct Layout {
+				uint32_t cellW_, cellH_;
+				uint32_t pos_[ 6 ][ 2 ];
+				bool isRotatedNZ_;
+			};
+			static const Layout layouts[] = {
+				{ 4, 3, { { 2, 1 }, { 0, 1 }, { 1, 0 }, { 1, 2 }, { 1, 1 }, { 3, 1 } }, false },	// Horizontal_Cross
+				{ 3, 4, { { 2, 1 }, { 0, 1 }, { 1, 0 }, { 1, 2 }, { 1, 1 }, { 1, 3 } }, true },		// Vertical_Cross
+				{ 1, 1, {}, false },																// Separable
+				{ 6, 1, { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 4, 0 }, { 5, 0 } }, false },	// Horizontal_Strip
+				{ 1, 6, { { 0, 0 }, { 0, 1 }, { 0, 2 }, { 0, 3 }, { 0, 4 }, { 0, 5 } }, false },	// Vertical_Strip
+			};
+			if ( (uint32_t)mapType >= sizeof( layouts ) / sizeof( layouts[ 0 ] ) )
+				return false;
+
+			// o͉摜̖ʂ̈ʒuɒڏ
+			Reconstructor::FaceTarget targets[ 6 ];
 			if ( mapType == CubeMapType::Separable ) {
+				out.resize( 6 );
 				for ( int i = 0; i < 6; ++i ) {
-					outImageBlocks.push_back( images[ i ] );
-				}
-			}
-			 
-			else if ( mapType == CubeMapType::Horizontal_Cross ) {
-				// NXɂ܂Ƃ߂
-				uint32_t bpc = 3;	// byteParColor
-				ImageBlockCustom hznImage( width * 4, width * 3, bpc, 0 );
-				uint32_t pitchByte = 4 * width * bpc;
-				uint32_t offsetsByte[ 6 ] = {
-					pitchByte * width + 2 * bpc * width,	// PX
-					pitchByte * width,						// NX
-					bpc * width,							// PY
-					pitchByte * 2 * width + width * bpc,	// NY
-					pitchByte * width + width * bpc,		// PZ
-					pitchByte * width + 3 * width * bpc,	// NZ
-				};
-				uint8_t *ptr = hznImage.p();
-				memset( ptr, 0x00, hznImage.size() );
-				uint32_t lineByte = width * bpc;
-				for ( uint32_t i = 0; i < 6; ++i ) {
-					uint8_t *dest = ptr + offsetsByte[ i ];
-					uint8_t *src = images[ i ].p();
-					for ( uint32_t y = 0; y < width; ++y ) {
-						memcpy( dest, src, lineByte );
-						dest += pitchByte;
-						src += lineByte;
+					reuse( out[ i ], width, width );
+					targets[ i ].origin_ = out[ i ].p();
+					targets[ i ].pitch_ = out[ i ].pitch();
+				}
+			} else {
+				const Layout &layout = layouts[ mapType ];
+				out.resize( 1 );
+				reuse( out[ 0 ], width * layout.cellW_, width * layout.cellH_ );
+				ImageBlock &image = out[ 0 ];
+				const uint64_t pitch = image.pitch();
+				const uint64_t cellByte = (uint64_t)width * format.bytePerColor();
+				bool isUsed[ 6 ][ 6 ] = {};
+				for ( int i = 0; i < 6; ++i ) {
+					const uint32_t cx = layout.pos_[ i ][ 0 ], cy = layout.pos_[ i ][ 1 ];
+					isUsed[ cy ][ cx ] = true;
+					targets[ i ].origin_ = image.p() + pitch * width * cy + cellByte * cx;
+					targets[ i ].pitch_ = pitch;
+					targets[ i ].rotated_ = ( layout.isRotatedNZ_ && i == CubeData::Face::NZ );
+				}
+
+				// ʂ̖0Ŗ߂
+				for ( uint32_t cy = 0; cy < layout.cellH_; ++cy ) {
+					for ( uint32_t cx = 0; cx < layout.cellW_; ++cx ) {
+						if ( isUsed[ cy ][ cx ] )
+							continue;
+						uint8_t *dest = image.p() + pitch * width * cy + cellByte * cx;
+						for ( uint32_t y = 0; y < width; ++y, dest += pitch )
+							memset( dest, 0x00, cellByte );
 					}
 				}
-				outImageBlocks.push_back( hznImage );
 			}
 
-			return outImageBlocks;
+			// ʂ^Cɕĕɍč\
+			if ( reconstructor.reconstruct( width, format, targets, proc ) == false )
+				return false;
+
+			return true;
+		}
+
+		// p[^琳~}@iܓxoxj̉摜쐬
+		ImageBlock createEquirectFromParameters( const Result &res, uint32_t width, uint32_t height, const std::function< void( uint64_t count, uint64_t procCount ) > &proc, ImageBlock::ComponentType type, ImageBlock::ColorSpace colorSpace, float gamma ) {
+			Workspace workspace;
+			ImageBlock out;
+			if ( createEquirectFromParameters( res, width, height, proc, workspace, out, type, colorSpace, gamma ) == false )
+				return ImageBlock();
+			return out;
+		}
+
+		// Ɨ̈Əo͐g񂵂Đ~}@̉摜쐬
+		bool createEquirectFromParameters( const Result &res, uint32_t width, uint32_t height, const std::function< void( uint64_t count, uint64_t procCount ) > &proc, Workspace &workspace, ImageBlock &out, ImageBlock::ComponentType type, ImageBlock::ColorSpace colorSpace, float gamma ) {
+			if ( width == 0 || height == 0 )
+				return false;
+			if ( workspace.reconstructor_ == nullptr )
+				workspace.reconstructor_ = std::make_shared< Reconstructor >();
+			Reconstructor &reconstructor = *workspace.reconstructor_;
+			reconstructor.setThreadNum( workspace.threadNum_ );
+			if ( reconstructor.setResult( res ) == false )
+				return false;
+
+			ImageBlock::PixelFormat format( 3, type, colorSpace );
+			format.gamma_ = gamma;
+			if ( ImageUtil::getRowEncoder( format ) == 0 )
+				return false;
+
+			// TCYƃtH[}bg̉摜͎g
+			const ImageBlock::PixelFormat &f = out.format();
+			if ( out.isExist() == false || out.width() != width || out.height() != height ||
+				f.channelNum_ != format.channelNum_ || f.type_ != format.type_ || f.colorSpace_ != format.colorSpace_ || f.gamma_ != format.gamma_ )
+				out = ImageBlockCustom( width, height, format, 0 );
+
+			// sɍč\
+			return reconstructor.reconstructEquirect( out, proc );
 		}
 
 
@@ -266,6 +496,23 @@ namespace OX {
 			return l;
 		}
 
+		// ʂ̒SƃeNZUAV̎擾
+		void CubeData::getFaceBasis( Face face, double *axis, double *u, double *v ) {
+			static const double table[ 6 ][ 3 ][ 3 ] = {
+				{ {  1,  0,  0 }, {  0,  0, -1 }, { 0, -1,  0 } },	// PX
+				{ { -1,  0,  0 }, {  0,  0,  1 }, { 0, -1,  0 } },	// NX
+				{ {  0,  1,  0 }, {  1,  0,  0 }, { 0,  0,  1 } },	// PY
+				{ {  0, -1,  0 }, {  1,  0,  0 }, { 0,  0, -1 } },	// NY
+				{ {  0,  0,  1 }, {  1,  0,  0 }, { 0, -1,  0 } },	// PZ
+				{ {  0,  0, -1 }, { -1,  0,  0 }, { 0, -1,  0 } },	// NZ
+			};
+			for ( int i = 0; i < 3; ++i ) {
+				axis[ i ] = table[ face ][ 0 ][ i ];
+				u[ i ] = table[ face ][ 1 ][ i ];
+				v[ i ] = table[ face ][ 2 ][ i ];
+			}
+		}
+
 		// wUVʒuɑ΂XYZW擾 (-1,-1,-1)`(1,1,1)
 		void CubeData::getXYZ( Face face, int32_t tu, int32_t tv, double &x, double &y, double &z ) const {
 			const int32_t w = getTexelSize();
@@ -277,6 +524,18 @@ namespace OX {
 			return getPolar( face, getTexelSize(), tu, tv, th, phi );
 		}
 
+		// ws̒l𕂓_RGBAŎ擾
+		void CubeData::getRow( Face face, int32_t v, float *rgba ) const {
+			const int32_t w = getTexelSize();
+			for ( int32_t u = 0; u < w; ++u ) {
+				RGBA c = getValue( face, u, v );
+				rgba[ u * 4 + 0 ] = c.r_ / 255.0f;
+				rgba[ u * 4 + 1 ] = c.g_ / 255.0f;
+				rgba[ u * 4 + 2 ] = c.b_ / 255.0f;
+				rgba[ u * 4 + 3 ] = c.a_ / 255.0f;
+			}
+		}
+
 
 
 
@@ -314,23 +573,156 @@ namespace OX {
 
 
 
+		// Ỹp[^擾
+		Parameter ParamList::operator []( uint32_t idx ) const {
+			if ( idx >= coefs_.size() )
+				return Parameter();
+			uint32_t l;
+			int32_t m;
+			Parameter::toLM( idx, l, m );
+			return Parameter( l, m, coefs_[ idx ] );
+		}
+
+
+
+
+		Result::Result( const Result &r ) {
+			*this = r;
+		}
+
+		Result &Result::operator =( const Result &r ) {
+			if ( this == &r )
+				return *this;
+			maxLevel_ = r.maxLevel_;
+			coefNum_ = r.coefNum_;
+			layout_ = r.layout_;
+			coefs_.resize( r.coefs_.size() );
+			if ( r.coefs_.size() > 0 )
+				memcpy( coefs_.data(), r.coefs_.data(), r.coefs_.size() * sizeof( double ) );
+			basis_ = r.basis_;
+			bandStats_ = r.bandStats_;
+			state_ = r.state_;
+			return *this;
+		}
+
+		Result::Result( Result &&r ) {
+			*this = std::move( r );
+		}
+
+		Result &Result::operator =( Result &&r ) {
+			if ( this == &r )
+				return *this;
+			maxLevel_ = r.maxLevel_;
+			coefNum_ = r.coefNum_;
+			layout_ = r.layout_;
+			coefs_ = std::move( r.coefs_ );
+			basis_ = r.basis_;
+			bandStats_ = std::move( r.bandStats_ );
+			state_ = r.state_;
+			r.maxLevel_ = 0;
+			r.coefNum_ = 0;
+			r.state_ = RS_NO_ESTIMATE;
+			return *this;
+		}
+
 		// Ԃ擾
 		ResultState Result::getState() const {
 			return state_;
 		}
 
+		// Wݒ
+		void Result::set( uint32_t maxLevel, const double *coefsR, const double *coefsG, const double *coefsB, double scale, BasisType basis ) {
+			const uint32_t num = ( maxLevel + 1 ) * ( maxLevel + 1 );
+			const double *coefs[ 3 ] = { coefsR, coefsG, coefsB };
+			coefs_.resize( 3ull * num );
+			coefNum_ = num;
+			for ( int c = 0; c < 3; ++c ) {
+				CoefSpan< double > dest = getCoefs( (ColorType)c );
+				for ( uint32_t i = 0; i < num; ++i )
+					dest[ i ] = coefs[ c ][ i ] * scale;
+			}
+			maxLevel_ = maxLevel;
+			basis_ = basis;
+			state_ = RS_OK;
+		}
+
+		// W̕тݒ
+		void Result::setLayout( CoefLayout layout ) {
+			if ( layout == layout_ )
+				return;
+			if ( coefNum_ > 0 ) {
+				Buffer< double > coefs( 3ull * coefNum_ );
+				for ( uint32_t c = 0; c < 3; ++c ) {
+					CoefSpan< const double > src = getCoefs( (ColorType)c );
+					const uint64_t base = ( layout == CoefLayout_Planar ? (uint64_t)c * coefNum_ : c );
+					const uint32_t stride = ( layout == CoefLayout_Planar ? 1 : 3 );
+					for ( uint32_t i = 0; i < coefNum_; ++i )
+						coefs[ base + (uint64_t)i * stride ] = src[ i ];
+				}
+				coefs_ = std::move( coefs );
+			}
+			layout_ = layout;
+		}
+
+		// W̕т擾
+		CoefLayout Result::getLayout() const {
+			return layout_;
+		}
+
+		// F̌W̐擾
+		uint32_t Result::getCoefNum() const {
+			return coefNum_;
+		}
+
+		// SĂ̌W擾
+		const double *Result::data() const {
+			return coefs_.data();
+		}
+
+		double *Result::data() {
+			return coefs_.data();
+		}
+
+		// F̌W̗擾
+		CoefSpan< const double > Result::getCoefs( ColorType ctype ) const {
+			if ( (uint32_t)ctype >= 3 || coefNum_ == 0 )
+				return CoefSpan< const double >();
+			if ( layout_ == CoefLayout_Planar )
+				return CoefSpan< const double >( coefs_.data() + (uint64_t)ctype * coefNum_, coefNum_, 1 );
+			return CoefSpan< const double >( coefs_.data() + (uint32_t)ctype, coefNum_, 3 );
+		}
+
+		CoefSpan< double > Result::getCoefs( ColorType ctype ) {
+			if ( (uint32_t)ctype >= 3 || coefNum_ == 0 )
+				return CoefSpan< double >();
+			if ( layout_ == CoefLayout_Planar )
+				return CoefSpan< double >( coefs_.data() + (uint64_t)ctype * coefNum_, coefNum_, 1 );
+			return CoefSpan< double >( coefs_.data() + (uint32_t)ctype, coefNum_, 3 );
+		}
+
 		// 莞̍őLevel擾
 		uint32_t Result::getMaxLevel() const {
 			return maxLevel_;
 		}
 
+		// ̎ނ擾
+		BasisType Result::getBasisType() const {
+			return basis_;
+		}
+
+		// oh̓vݒ
+		void Result::setBandStatistics( const BandStatistics *stats, uint32_t num ) {
+			bandStats_.assign( stats, stats + num );
+		}
+
+		// oh̓v擾
+		const std::vector< Result::BandStatistics > &Result::getBandStatistics() const {
+			return bandStats_;
+		}
+
 		// p[^Xg擾
-		const std::vector< Parameter > &Result::getParamList( ColorType ctype ) const {
-			static std::vector< Parameter > nullParamVec;
-			if ( (size_t)ctype >= paramsVec_.size() ) {
-				return nullParamVec;
-			}
-			return paramsVec_[ (size_t)ctype ];
+		ParamList Result::getParamList( ColorType ctype ) const {
+			return ParamList( getCoefs( ctype ) );
 		}
 
 		// wCfbNX̃p[^擾
@@ -339,12 +731,9 @@ namespace OX {
 			// (l,m) = (0,0), (1,-1), (1,0), (1,1), (2,-2), (2,-1), ...
 			// ƕłO
 
-			size_t colorIdx = (size_t)ctype;
-			if ( colorIdx >= paramsVec_.size() || (int32_t)l < -m || (int32_t)l < m )
+			if ( (int32_t)l < -m || (int32_t)l < m )
 				return Parameter();
-
-			int32_t idx = l * l + l + m;
-			return ( idx >= paramsVec_[ colorIdx ].size() ? Parameter() : paramsVec_[ colorIdx ][ idx ] );
+			return getParamList( ctype )[ l * l + l + m ];
 		}
 
 
@@ -364,10 +753,113 @@ namespace OX {
 			return Error();
 		}
 
+		// ϓ_ݒ
+		void SphereEstimater::setQuadrature( uint32_t thetaNum, uint32_t phiNum ) {
+			thetaNum_ = thetaNum;
+			phiNum_ = phiNum;
+			nodes_.clear();
+			weights_.clear();
+		}
+
+		// 
+		Error SphereEstimater::estimate( const SphereData *sphere, Result &res ) {
+			if ( sphere == 0 )
+				return Error( "Null object" );
+			if ( thetaNum_ == 0 || phiNum_ == 0 )
+				return Error( "invalid quadrature." );
+
+			const double pi = 3.14159265358979323846;
+
+			// Gauss-Legendre_j[g@ō쐬
+			if ( nodes_.size() != thetaNum_ ) {
+				nodes_.resize( thetaNum_ );
+				weights_.resize( thetaNum_ );
+				const uint32_t n = thetaNum_;
+				for ( uint32_t i = 0; i < n; ++i ) {
+					double x = cos( pi * ( i + 0.75 ) / ( n + 0.5 ) );
+					double dp = 1.0;
+					for ( int iter = 0; iter < 100; ++iter ) {
+						double p0 = 1.0, p1 = x;
+						for ( uint32_t k = 2; k <= n; ++k ) {
+							double p2 = ( ( 2.0 * k - 1 ) * x * p1 - ( k - 1.0 ) * p0 ) / k;
+							p0 = p1;
+							p1 = p2;
+						}
+						if ( n == 1 )
+							p0 = 1.0;
+						dp = n * ( x * p1 - p0 ) / ( x * x - 1.0 );
+						double dx = p1 / dp;
+						x -= dx;
+						if ( fabs( dx ) < 1.0e-15 )
+							break;
+					}
+					nodes_[ i ] = x;
+					weights_[ i ] = 2.0 / ( ( 1.0 - x * x ) * dp * dp );
+				}
+			}
+
+			const uint32_t fnum = ( maxLevel_ + 1 ) * ( maxLevel_ + 1 );
+			std::vector< double > coefs( fnum * 3, 0.0 );
+			std::vector< double > yvals( fnum );
+			double *coefsR = &coefs[ 0 ];
+			double *coefsG = &coefs[ fnum ];
+			double *coefsB = &coefs[ fnum * 2 ];
+			const double dphi = 2.0 * pi / phiNum_;
+			for ( uint32_t i = 0; i < thetaNum_; ++i ) {
+				const double y = nodes_[ i ];
+				const double th = acos( y );
+				const double sinTh = sqrt( 1.0 - y * y );
+				const double dw = weights_[ i ] * dphi;
+				for ( uint32_t j = 0; j < phiNum_; ++j ) {
+					const double phi = dphi * j;
+					double r, g, b;
+					sphere->getRGB( th, phi, r, g, b );
+					evalSphericalHarmonics( maxLevel_, sinTh * cos( phi ), y, sinTh * sin( phi ), yvals.data() );
+					for ( uint32_t f = 0; f < fnum; ++f ) {
+						double shVal = yvals[ f ] * dw;
+						coefsR[ f ] += r * shVal;
+						coefsG[ f ] += g * shVal;
+						coefsB[ f ] += b * shVal;
+					}
+				}
+			}
+
+			res.set( maxLevel_, coefsR, coefsG, coefsB, 1.0 );
+			return Error();
+		}
+
+
 
+		// }XN̕␳@ݒ
+		void CubeEstimater::setMaskCorrection( MaskCorrection correction, double lambda ) {
+			maskCorrection_ = correction;
+			maskLambda_ = lambda;
+		}
+
+		// }XN̕␳@擾
+		CubeEstimater::MaskCorrection CubeEstimater::getMaskCorrection() const {
+			return maskCorrection_;
+		}
+
+		// xIݒ
+		void CubeEstimater::setAutoLevel( double errorTarget, double energyTarget ) {
+			errorTarget_ = errorTarget;
+			energyTarget_ = energyTarget;
+		}
+
+		// xIL
+		bool CubeEstimater::isAutoLevel() const {
+			return ( errorTarget_ > 0.0 || energyTarget_ > 0.0 );
+		}
 
 		// 
 		Error CubeEstimater::estimate( const CubeData *cube, Result &res, const std::function< void( uint64_t count, uint64_t procCount ) > &proc ) {
+			Workspace workspace;
+			return estimate( cube, res, proc, workspace );
+		}
+
+		// Ɨ̈g񂵂Đ
+		Error CubeEstimater::estimate( const CubeData *cube, Result &res, const std::function< void( uint64_t count, uint64_t procCount ) > &proc, Workspace &workspace ) {
 			if ( cube == 0 )
 				return Error( "Null object" );
 
@@ -375,35 +867,231 @@ namespace OX {
 			double texelSize2 = cube->getTexelSize();
 			texelSize2 *= texelSize2;
 
-			// (l,m)ɑΉʒa֐ƃp[^zp
-			auto shFuncs = createSphericalHarmonicsFuncs( maxLevel_ );
-			std::vector< double > coefsR( shFuncs.size() );
-			std::vector< double > coefsG( shFuncs.size() );
-			std::vector< double > coefsB( shFuncs.size() );
-			for ( size_t i = 0; i < shFuncs.size(); ++i ) {
-				coefsR[ i ] = 0.0;
-				coefsG[ i ] = 0.0;
-				coefsB[ i ] = 0.0;
+			// (l,m)ɑΉlƌẄ̗p
+			const uint32_t fnum = ( maxLevel_ + 1 ) * ( maxLevel_ + 1 );
+			workspace.basis_.resize( fnum );
+			workspace.coefs_.resize( fnum * 3 );
+			double *yvals = workspace.basis_.data();
+			double *coefsR = &workspace.coefs_[ 0 ];
+			double *coefsG = &workspace.coefs_[ fnum ];
+			double *coefsB = &workspace.coefs_[ fnum * 2 ];
+			for ( uint32_t i = 0; i < fnum * 3; ++i )
+				workspace.coefs_[ i ] = 0.0;
+
+			// }XNL̏ꍇ͗Lȗ̊pWv
+			// ŏ␳ł̓OsWv
+			const bool useMask = cube->hasMask();
+			const bool useLeastSquares = ( useMask && maskCorrection_ == MaskCorrection_LeastSquares );
+			double *gram = 0;
+			if ( useLeastSquares ) {
+				workspace.gram_.resize( fnum * fnum );
+				gram = workspace.gram_.data();
+				for ( uint32_t i = 0; i < fnum * fnum; ++i )
+					gram[ i ] = 0.0;
 			}
+			double validSolidAngle = 0.0;
+			double inputEnergy = 0.0;	// ̗͂̓̊pϕiRGB̘aj
 
-			// 6ʂꂼCe[V
+			// 6ʂꂼ^CPʂŃCe[V
+			const int32_t tileSize = 16;
 			int32_t width = cube->getTexelSize();
-			uint32_t procCount = width * width * (size_t)CubeData::Face::Face_Num;
-			uint32_t count = 0;
+			workspace.rows_.resize( (uint64_t)tileSize * width * 4 );	// ^Cs̒l
+			float *rows = workspace.rows_.data();
+			uint64_t procCount = (uint64_t)width * width * CubeData::Face::Face_Num;
+			uint64_t count = 0;
 			for ( size_t i = 0; i < (size_t)CubeData::Face::Face_Num; ++i ) {
 				CubeData::Face face = ( CubeData::Face )i;
-				for ( int32_t v = 0; v < width; ++v ) {
+				for ( int32_t tv = 0; tv < width; tv += tileSize ) {
+					int32_t tileH = ( tv + tileSize > width ? width - tv : tileSize );
+					for ( int32_t v = 0; v < tileH; ++v )
+						cube->getRow( face, tv + v, &rows[ (size_t)v * width * 4 ] );
+					for ( int32_t tu = 0; tu < width; tu += tileSize ) {
+						int32_t tileW = ( tu + tileSize > width ? width - tu : tileSize );
+
+						// Să}XNꂽ^C͊̌vZXLbv
+						if ( useMask && cube->isRegionMasked( face, tu, tv, tileW, tileH ) ) {
+							for ( int32_t n = 0; n < tileW * tileH; ++n ) {
+								proc( count, procCount );
+								count++;
+							}
+							continue;
+						}
+
+						for ( int32_t v = tv; v < tv + tileH; ++v ) {
+							for ( int32_t u = tu; u < tu + tileW; ++u ) {
+								double weight = ( useMask ? cube->getWeight( face, u, v ) : 1.0 );
+								if ( weight <= 0.0 ) {
+									proc( count, procCount );
+									count++;
+									continue;
+								}
+
+								double x, y, z;
+								const float *value = &rows[ ( ( v - tv ) * width + u ) * 4 ];
+								cube->getXYZ( face, u, v, x, y, z );
+								double l = sqrt( x * x + y * y + z * z );
+								double dw = weight / ( l * l * l );
+								validSolidAngle += dw;
+								inputEnergy += ( value[ 0 ] * value[ 0 ] + value[ 1 ] * value[ 1 ] + value[ 2 ] * value[ 2 ] ) * dw;
+
+								// ey_lm֐ɂĒlZo
+								evalSphericalHarmonics( maxLevel_, x / l, y / l, z / l, yvals );
+								for ( uint32_t f = 0; f < fnum; ++f ) {
+									double shVal = yvals[ f ] * dw;
+									coefsR[ f ] += value[ 0 ] * shVal;
+									coefsG[ f ] += value[ 1 ] * shVal;
+									coefsB[ f ] += value[ 2 ] * shVal;
+								}
+								if ( useLeastSquares ) {
+									for ( uint32_t r = 0; r < fnum; ++r ) {
+										double yr = yvals[ r ] * dw;
+										for ( uint32_t c = 0; c <= r; ++c )
+											gram[ r * fnum + c ] += yr * yvals[ c ];
+									}
+								}
+								proc( count, procCount );
+								count++;
+							}
+						}
+					}
+				}
+			}
+
+			// ̊p̕␳
+			double scale = 4.0 / texelSize2;
+			validSolidAngle *= scale;
+			if ( useMask ) {
+				if ( validSolidAngle <= 0.0 )
+					return Error( "all texels are masked." );
+				if ( maskCorrection_ == MaskCorrection_Renormalize ) {
+					scale *= 4.0 * 3.14159265358979323846 / validSolidAngle;
+				}
+				else if ( useLeastSquares ) {
+					// SLȏꍇɒPʍsƂȂ悤KĂ琳
+					for ( uint32_t r = 0; r < fnum; ++r ) {
+						uint32_t l;
+						int32_t m;
+						Parameter::toLM( r, l, m );
+						for ( uint32_t c = 0; c <= r; ++c )
+							gram[ r * fnum + c ] *= scale;
+						coefsR[ r ] *= scale;
+						coefsG[ r ] *= scale;
+						coefsB[ r ] *= scale;
+						gram[ r * fnum + r ] += maskLambda_ * ( l * ( l + 1.0 ) ) * ( l * ( l + 1.0 ) );
+						for ( uint32_t c = 0; c < r; ++c )
+							gram[ c * fnum + r ] = gram[ r * fnum + c ];
+					}
+					if ( choleskyDecompose( gram, fnum ) == false )
+						return Error( "too many texels are masked to solve least squares. increase lambda." );
+					choleskyForward( gram, fnum, coefsR );
+					choleskyForward( gram, fnum, coefsG );
+					choleskyForward( gram, fnum, coefsB );
+				}
+			}
+
+			// oh̓v
+			//  KȎˉeł̓ohL܂ł̍č\̓덷͓͂̃GlM[W̓áiParsevalj
+			//  ŏ␳ł͑Oỉyœ֌Wi|y|^2 = b^T G^-1 bj藧A
+			//  y̐擪͏̃ohɈ˂Ȃ߁A1x̎ˉeŃoh1ꍇ]ł
+			const double energyScale = ( useLeastSquares ? 1.0 : scale * scale );
+			inputEnergy *= ( useLeastSquares ? 4.0 / texelSize2 : scale );
+			workspace.bandStats_.resize( maxLevel_ + 1 );
+			Result::BandStatistics *stats = workspace.bandStats_.data();
+			uint32_t level = maxLevel_;
+			bool selected = false;
+			double captured = 0.0;
+			for ( uint32_t l = 0; l <= maxLevel_; ++l ) {
+				double energy = 0.0;
+				for ( uint32_t f = l * l; f < ( l + 1 ) * ( l + 1 ); ++f )
+					energy += ( coefsR[ f ] * coefsR[ f ] + coefsG[ f ] * coefsG[ f ] + coefsB[ f ] * coefsB[ f ] ) * energyScale;
+				captured += energy;
+				auto &st = stats[ l ];
+				st.energy_ = energy;
+				st.capturedRatio_ = ( inputEnergy > 0.0 ? std::min( captured / inputEnergy, 1.0 ) : 1.0 );
+				st.residual_ = sqrt( 1.0 - st.capturedRatio_ );
+				if ( selected == false && isAutoLevel() ) {
+					if ( ( errorTarget_ > 0.0 && st.residual_ <= errorTarget_ ) || ( energyTarget_ > 0.0 && st.capturedRatio_ >= energyTarget_ ) ) {
+						level = l;
+						selected = true;
+					}
+				}
+			}
+			if ( useLeastSquares ) {
+				// I񂾃x̐擪̃ubNŉ
+				const uint32_t num = ( level + 1 ) * ( level + 1 );
+				choleskyBackward( gram, fnum, num, coefsR );
+				choleskyBackward( gram, fnum, num, coefsG );
+				choleskyBackward( gram, fnum, num, coefsB );
+				scale = 1.0;
+			}
+
+			// Wp[^i[
+			res.set( level, coefsR, coefsG, coefsB, scale );
+			res.setBandStatistics( stats, maxLevel_ + 1 );
+
+			return Error();
+		}
+
+
+
+		// 
+		Error HemisphereCubeEstimater::estimate( const CubeData *cube, Result &res, const std::function< void( uint64_t count, uint64_t procCount ) > &proc ) {
+			Workspace workspace;
+			return estimate( cube, res, proc, workspace );
+		}
+
+		// Ɨ̈g񂵂Đ
+		Error HemisphereCubeEstimater::estimate( const CubeData *cube, Result &res, const std::function< void( uint64_t count, uint64_t procCount ) > &proc, Workspace &workspace ) {
+			if ( cube == 0 )
+				return Error( "Null object" );
+
+			const int32_t width = cube->getTexelSize();
+			const uint32_t fnum = ( maxLevel_ + 1 ) * ( maxLevel_ + 1 );
+			workspace.basis_.resize( fnum );
+			workspace.coefs_.resize( fnum * 3 );
+			workspace.rows_.resize( (uint64_t)width * 4 );
+			for ( uint32_t i = 0; i < fnum * 3; ++i )
+				workspace.coefs_[ i ] = 0.0;
+			double *yvals = workspace.basis_.data();
+			double *coefsR = &workspace.coefs_[ 0 ];
+			double *coefsG = &workspace.coefs_[ fnum ];
+			double *coefsB = &workspace.coefs_[ fnum * 2 ];
+			const bool useMask = cube->hasMask();
+			float *row = workspace.rows_.data();
+
+			// 㔼Ɋ|ŝݏ
+			//  Y+ʂ͑ŚAʂy > 0̏㔼i̏ꍇy = 0̍s͏d1/2jAY-ʂ͏Ȃ
+			const int32_t halfRows = width / 2;
+			const int32_t sideRows = halfRows + ( width % 2 );
+			uint64_t procCount = (uint64_t)width * width + 4ull * sideRows * width;
+			uint64_t count = 0;
+			for ( uint32_t f = 0; f < CubeData::Face::Face_Num; ++f ) {
+				CubeData::Face face = ( CubeData::Face )f;
+				if ( face == CubeData::NY )
+					continue;
+				const int32_t rows = ( face == CubeData::PY ? width : sideRows );
+				for ( int32_t v = 0; v < rows; ++v ) {
+					const double rowWeight = ( face != CubeData::PY && v == halfRows ? 0.5 : 1.0 );
+					cube->getRow( face, v, row );
 					for ( int32_t u = 0; u < width; ++u ) {
-						double th, phi;
-						RGBA value = cube->getValue( face, u, v );
-						double l = cube->getPolar( face, u, v, th, phi );
-
-						// ey_lm֐ɂĒlZo
-						for ( size_t f = 0; f < shFuncs.size(); ++f ) {
-							double shVal = shFuncs[ f ]( th, phi ) / ( l * l * l );
-							coefsR[ f ] += value.dr() * shVal;
-							coefsG[ f ] += value.dg() * shVal;
-							coefsB[ f ] += value.db() * shVal;
+						double weight = rowWeight * ( useMask ? cube->getWeight( face, u, v ) : 1.0 );
+						if ( weight <= 0.0 ) {
+							proc( count, procCount );
+							count++;
+							continue;
+						}
+						double x, y, z;
+						cube->getXYZ( face, u, v, x, y, z );
+						double l = sqrt( x * x + y * y + z * z );
+						evalHemisphericalHarmonics( maxLevel_, x / l, ( y > 0.0 ? y / l : 0.0 ), z / l, yvals );
+
+						const float *value = &row[ u * 4 ];
+						double dw = weight / ( l * l * l );
+						const double r = value[ 0 ] * dw, g = value[ 1 ] * dw, b = value[ 2 ] * dw;
+						for ( uint32_t i = 0; i < fnum; ++i ) {
+							coefsR[ i ] += r * yvals[ i ];
+							coefsG[ i ] += g * yvals[ i ];
+							coefsB[ i ] += b * yvals[ i ];
 						}
 						proc( count, procCount );
 						count++;
@@ -411,29 +1099,214 @@ namespace OX {
 				}
 			}
 
-			// Wp[^i[
-			std::vector< Parameter > paramsR;
-			std::vector< Parameter > paramsG;
-			std::vector< Parameter > paramsB;
-			for ( size_t i = 0; i < coefsR.size(); ++i ) {
-				uint32_t l;
-				int32_t m;
-				Parameter::toLM( (uint32_t)i, l, m );
-				paramsR.push_back( Parameter( l, m, coefsR[ i ] * 4.0 / texelSize2 ) );
-				paramsG.push_back( Parameter( l, m, coefsG[ i ] * 4.0 / texelSize2 ) );
-				paramsB.push_back( Parameter( l, m, coefsB[ i ] * 4.0 / texelSize2 ) );
+			res.set( maxLevel_, coefsR, coefsG, coefsB, 4.0 / ( (double)width * width ), BasisType_HSH );
+			return Error();
+		}
+
+
+
+		// ŏ搄̕
+		struct LeastSquaresEstimater::Factorization {
+			uint32_t level_ = 0;
+			double lambda_ = 0.0;
+			std::vector< double > dirs_;	// Tv(xyz)
+			std::vector< double > basis_;	// s(Tv x ֐)
+			std::vector< double > chol_;	// Os̃RXL[(֐ x ֐)
+			uint64_t lastUse_ = 0;			// ŌɎguseCount_
+		};
+
+		LeastSquaresEstimater::LeastSquaresEstimater( uint32_t maxLevel, double lambda ) : Estimater( maxLevel ), lambda_( lambda ) {
+		}
+
+		LeastSquaresEstimater::~LeastSquaresEstimater() {
+		}
+
+		// 
+		Error LeastSquaresEstimater::estimate( const SampleData *samples, Result &res ) {
+			if ( samples == 0 )
+				return Error( "Null object" );
+
+			uint32_t sampleNum = samples->getSampleNum();
+			if ( sampleNum == 0 )
+				return Error( "no sample." );
+
+			// WL[쐬
+			std::vector< double > dirs( sampleNum * 3 );
+			for ( uint32_t i = 0; i < sampleNum; ++i )
+				samples->getDirection( i, dirs[ i * 3 + 0 ], dirs[ i * 3 + 1 ], dirs[ i * 3 + 2 ] );
+			uint64_t key = hashBytes( dirs.data(), dirs.size() * sizeof( double ) );
+			key = hashBytes( &maxLevel_, sizeof( maxLevel_ ), key );
+			key = hashBytes( &lambda_, sizeof( lambda_ ), key );
+
+			// LbV
+			uint32_t fnum = ( maxLevel_ + 1 ) * ( maxLevel_ + 1 );
+			std::shared_ptr< Factorization > fact;
+			auto &bucket = cache_[ key ];
+			for ( auto &f : bucket ) {
+				if ( f->level_ == maxLevel_ && f->lambda_ == lambda_ && f->dirs_ == dirs ) {
+					fact = f;
+					break;
+				}
 			}
 
-			std::vector< std::vector< Parameter > > paramsVec;
-			paramsVec.push_back( paramsR );
-			paramsVec.push_back( paramsG );
-			paramsVec.push_back( paramsB );
+			// ΊsƃOs쐬ĕ
+			if ( !fact ) {
+				fact.reset( new Factorization );
+				fact->level_ = maxLevel_;
+				fact->lambda_ = lambda_;
+				fact->basis_.resize( (size_t)sampleNum * fnum );
+				for ( uint32_t i = 0; i < sampleNum; ++i ) {
+					const double *d = &dirs[ i * 3 ];
+					double len = sqrt( d[ 0 ] * d[ 0 ] + d[ 1 ] * d[ 1 ] + d[ 2 ] * d[ 2 ] );
+					if ( len <= 0.0 ) {
+						if ( bucket.empty() )
+							cache_.erase( key );
+						return Error( "invalid sample direction." );
+					}
+					evalSphericalHarmonics( maxLevel_, d[ 0 ] / len, d[ 1 ] / len, d[ 2 ] / len, &fact->basis_[ (size_t)i * fnum ] );
+				}
 
-			res = Result( maxLevel_, paramsVec );
+				fact->chol_.assign( fnum * fnum, 0.0 );
+				for ( uint32_t i = 0; i < sampleNum; ++i ) {
+					const double *y = &fact->basis_[ (size_t)i * fnum ];
+					for ( uint32_t r = 0; r < fnum; ++r ) {
+						for ( uint32_t c = 0; c <= r; ++c )
+							fact->chol_[ r * fnum + c ] += y[ r ] * y[ c ];
+					}
+				}
+				for ( uint32_t r = 0; r < fnum; ++r ) {
+					uint32_t l;
+					int32_t m;
+					Parameter::toLM( r, l, m );
+					fact->chol_[ r * fnum + r ] += lambda_ * ( l * ( l + 1.0 ) ) * ( l * ( l + 1.0 ) );
+					for ( uint32_t c = 0; c < r; ++c )
+						fact->chol_[ c * fnum + r ] = fact->chol_[ r * fnum + c ];
+				}
+				if ( choleskyDecompose( fact->chol_.data(), fnum ) == false ) {
+					if ( bucket.empty() )
+						cache_.erase( key );
+					std::stringstream ss;
+					ss << "gram matrix is not positive definite. (samples = " << sampleNum << ", functions = " << fnum << ") increase samples or lambda.";
+					return Error( ss.str() );
+				}
+				fact->dirs_.swap( dirs );
+				bucket.push_back( fact );
+				cacheNum_++;
+			}
+			fact->lastUse_ = ++useCount_;
+			trimCache( maxCacheNum_ );
+
+			// Eӂ쐬ċ
+			std::vector< double > coefs( fnum * 3, 0.0 );
+			double *coefsR = &coefs[ 0 ];
+			double *coefsG = &coefs[ fnum ];
+			double *coefsB = &coefs[ fnum * 2 ];
+			for ( uint32_t i = 0; i < sampleNum; ++i ) {
+				double r, g, b;
+				samples->getValue( i, r, g, b );
+				const double *y = &fact->basis_[ (size_t)i * fnum ];
+				for ( uint32_t f = 0; f < fnum; ++f ) {
+					coefsR[ f ] += r * y[ f ];
+					coefsG[ f ] += g * y[ f ];
+					coefsB[ f ] += b * y[ f ];
+				}
+			}
+			choleskySolve( fact->chol_.data(), fnum, coefsR );
+			choleskySolve( fact->chol_.data(), fnum, coefsG );
+			choleskySolve( fact->chol_.data(), fnum, coefsB );
 
+			res.set( maxLevel_, coefsR, coefsG, coefsB, 1.0 );
 			return Error();
 		}
 
+		// W擾
+		double LeastSquaresEstimater::getLambda() const {
+			return lambda_;
+		}
+
+		// LbVĂ镪ʂ̐擾
+		size_t LeastSquaresEstimater::getCacheNum() const {
+			return cacheNum_;
+		}
+
+		// LbV镪ʂ̍ő吔ݒ
+		void LeastSquaresEstimater::setMaxCacheNum( size_t num ) {
+			maxCacheNum_ = num;
+			trimCache( maxCacheNum_ );
+		}
+
+		// LbV镪ʂ̍ő吔擾
+		size_t LeastSquaresEstimater::getMaxCacheNum() const {
+			return maxCacheNum_;
+		}
+
+		// LbVj
+		void LeastSquaresEstimater::clearCache() {
+			cache_.clear();
+			cacheNum_ = 0;
+		}
+
+		// ʂnumȉɂȂ܂ōłgĂȂ̂j
+		//  LbV͏Ȃ̂őŜ𑖍
+		void LeastSquaresEstimater::trimCache( size_t num ) {
+			while ( cacheNum_ > num ) {
+				auto oldestBucket = cache_.end();
+				size_t oldestIdx = 0;
+				for ( auto it = cache_.begin(); it != cache_.end(); ++it ) {
+					for ( size_t i = 0; i < it->second.size(); ++i ) {
+						if ( oldestBucket == cache_.end() || it->second[ i ]->lastUse_ < oldestBucket->second[ oldestIdx ]->lastUse_ ) {
+							oldestBucket = it;
+							oldestIdx = i;
+						}
+					}
+				}
+				if ( oldestBucket == cache_.end() )
+					break;
+				oldestBucket->second.erase( oldestBucket->second.begin() + oldestIdx );
+				if ( oldestBucket->second.empty() )
+					cache_.erase( oldestBucket );
+				cacheNum_--;
+			}
+		}
+
+
+
+		// Tvǉ
+		void SampleDataCustom::addSample( double th, double phi, double r, double g, double b ) {
+			double sinTh = sin( th );
+			dirs_.push_back( sinTh * cos( phi ) );
+			dirs_.push_back( cos( th ) );
+			dirs_.push_back( sinTh * sin( phi ) );
+			values_.push_back( r );
+			values_.push_back( g );
+			values_.push_back( b );
+		}
+
+		// TvSč폜
+		void SampleDataCustom::clear() {
+			dirs_.clear();
+			values_.clear();
+		}
+
+		// Tv擾
+		uint32_t SampleDataCustom::getSampleNum() const {
+			return (uint32_t)( values_.size() / 3 );
+		}
+
+		// wTv̕擾iPʃxNgj
+		void SampleDataCustom::getDirection( uint32_t idx, double &x, double &y, double &z ) const {
+			x = dirs_[ idx * 3 + 0 ];
+			y = dirs_[ idx * 3 + 1 ];
+			z = dirs_[ idx * 3 + 2 ];
+		}
+
+		// wTv̒l擾
+		void SampleDataCustom::getValue( uint32_t idx, double &r, double &g, double &b ) const {
+			r = values_[ idx * 3 + 0 ];
+			g = values_[ idx * 3 + 1 ];
+			b = values_[ idx * 3 + 2 ];
+		}
+
 
 
 		// 
@@ -442,9 +1315,22 @@ namespace OX {
 			if ( fileNames.size() < 6 ) {
 				return Error( "lack of cube map files." );
 			}
+			// k͐擪̖ʂ̃TCYŌ߁A擪̖ʂkfR[hłꍇ̂ݏk
+			decodeScale_ = 1;
+			uint32_t fileW = 0, fileH = 0;
+			if ( reducedLevel_ >= 0 && ImageUtil::getImageSize( fileNames[ 0 ].c_str(), fileW, fileH ) ) {
+				const uint32_t minW = minReducedWidth( reducedLevel_ );
+				while ( decodeScale_ < 8 && fileW / ( decodeScale_ * 2 ) >= minW )
+					decodeScale_ *= 2;
+			}
 			std::stringstream ss;
 			for ( size_t i = 0; i < fileNames.size(); ++i ) {
-				ImageBlock block = ImageUtil::createImageBlockFromFile( fileNames[ i ].c_str() );
+				uint32_t appliedScale = 1;
+				ImageBlock block = ImageUtil::createImageBlockFromFile( fileNames[ i ].c_str(), decodeScale_, &appliedScale );
+				if ( i == 0 )
+					decodeScale_ = appliedScale;
+				else if ( appliedScale < decodeScale_ )
+					block = ImageUtil::reduceImageBlock( block, decodeScale_ / appliedScale );
 				if ( block.isExist() == false ) {
 					ss << "invalid file. [" << fileNames[ i ] << "]";
 					return Error( ss.str() );
@@ -471,18 +1357,261 @@ namespace OX {
 				}
 				images_[ i ] = block;
 			}
+			clearMask();
+			return updateDecoders();
+		}
+
+		// ImageBlock珉
+		Error CubeDataFromImage::initialize( const ImageBlock *images ) {
+			if ( images == 0 )
+				return Error( "lack of cube map images." );
+			for ( int i = 0; i < 6; ++i ) {
+				const ImageBlock &block = images[ i ];
+				if ( block.isExist() == false )
+					return Error( "invalid cube map image." );
+				if ( block.width() != block.height() || block.width() != images[ 0 ].width() ) {
+					std::stringstream ss;
+					ss << "invalid texture size. [face " << i
+						<< " : width = " << block.width()
+						<< ", height = " << block.height()
+						<< "]";
+					return Error( ss.str() );
+				}
+			}
+			for ( int i = 0; i < 6; ++i )
+				images_[ i ] = images[ i ];
+			decodeScale_ = 1;
+			clearMask();
+			return updateDecoders();
+		}
+
+		// Ăяõ珉
+		Error CubeDataFromImage::initialize( const void *const *faces, uint32_t width, uint64_t pitch, const ImageBlock::PixelFormat &format ) {
+			if ( faces == 0 || width == 0 )
+				return Error( "lack of cube map images." );
+			if ( pitch != 0 && pitch < (uint64_t)width * format.bytePerColor() )
+				return Error( "pitch is less than row size." );
+			ImageBlock images[ 6 ];
+			for ( int i = 0; i < 6; ++i )
+				images[ i ] = ImageBlockRef( width, width, format, faces[ i ], pitch );
+			return initialize( images );
+		}
+
+		// ͂̐FԂݒ
+		void CubeDataFromImage::setColorSpace( ImageBlock::ColorSpace colorSpace, float gamma ) {
+			colorSpace_ = colorSpace;
+			gamma_ = gamma;
+			isColorSpaceSet_ = true;
+			if ( images_[ 0 ].isExist() )
+				updateDecoders();
+		}
+
+		// kfR[hݒ
+		void CubeDataFromImage::setReducedDecode( int32_t maxLevel ) {
+			reducedLevel_ = maxLevel;
+		}
+
+		// ǂݍݎ̏k擾
+		uint32_t CubeDataFromImage::getDecodeScale() const {
+			return decodeScale_;
+		}
+
+		// kfR[hŋeŏ̖ʂ̕
+		//  xl͖̊ʂ̕(90x)ōől / 2xÛŁA132eNZȏc
+		uint32_t CubeDataFromImage::minReducedWidth( int32_t maxLevel ) {
+			return 16 * ( maxLevel + 1 );
+		}
+
+		// s̕ϊ֐XV
+		//  FԂ̃e[u͐̌^ƐFԂʂŋL
+		Error CubeDataFromImage::updateDecoders() {
+			for ( int i = 0; i < 6; ++i ) {
+				const ImageBlock::PixelFormat format = getDecodeFormat( i );
+				decoders_[ i ] = ImageUtil::getRowDecoder( format );
+				if ( decoders_[ i ] == 0 )
+					return Error( "unsupported pixel format." );
+				decodersLUT_[ i ] = 0;
+				decodeTables_[ i ].reset();
+				if ( format.colorSpace_ == ImageBlock::ColorSpace_Linear )
+					continue;
+				decodersLUT_[ i ] = ImageUtil::getRowDecoderLUT( format );
+				if ( decodersLUT_[ i ] == 0 )
+					continue;
+				for ( int j = 0; j < i; ++j ) {
+					const ImageBlock::PixelFormat other = getDecodeFormat( j );
+					if ( decodeTables_[ j ] && other.type_ == format.type_ && other.colorSpace_ == format.colorSpace_ && other.gamma_ == format.gamma_ ) {
+						decodeTables_[ i ] = decodeTables_[ j ];
+						break;
+					}
+				}
+				if ( !decodeTables_[ i ] )
+					decodeTables_[ i ] = std::make_shared< std::vector< float > >( ImageUtil::createDecodeTable( format ) );
+			}
+			return Error();
+		}
+
+		// At@l}XNƂĎgp
+		Error CubeDataFromImage::setMaskFromAlpha() {
+			if ( images_[ 0 ].isExist() == false )
+				return Error( "cube data is not initialized." );
+			for ( int i = 0; i < 6; ++i ) {
+				if ( images_[ i ].channelNum() != 4 )
+					return Error( "image has no alpha channel." );
+			}
+			for ( int i = 0; i < 6; ++i ) {
+				const int32_t w = images_[ i ].width();
+				std::vector< float > row( w * 4 );
+				weights_[ i ].resize( (size_t)w * w );
+				for ( int32_t v = 0; v < w; ++v ) {
+					getRow( (Face)i, v, row.data() );
+					for ( int32_t u = 0; u < w; ++u )
+						weights_[ i ][ (size_t)v * w + u ] = clampWeight( row[ u * 4 + 3 ] );
+				}
+			}
+			updateMaskTiles();
 			return Error();
 		}
 
+		// }XN摜ݒ
+		Error CubeDataFromImage::setMaskFromFiles( const std::vector< std::string > &fileNames ) {
+			if ( images_[ 0 ].isExist() == false )
+				return Error( "cube data is not initialized." );
+			if ( fileNames.size() < 6 )
+				return Error( "lack of mask files." );
+			std::vector< float > weights[ 6 ];
+			for ( int i = 0; i < 6; ++i ) {
+				ImageBlock block = ImageUtil::createImageBlockFromFile( fileNames[ i ].c_str() );
+				if ( decodeScale_ > 1 && block.width() == images_[ i ].width() * decodeScale_ )
+					block = ImageUtil::reduceImageBlock( block, decodeScale_ );
+				if ( block.isExist() == false || block.width() != images_[ i ].width() || block.height() != images_[ i ].height() ) {
+					std::stringstream ss;
+					ss << "invalid mask file or size mismatch. [" << fileNames[ i ] << "]";
+					return Error( ss.str() );
+				}
+				ImageUtil::RowDecoder decoder = ImageUtil::getRowDecoder( block.format() );
+				if ( decoder == 0 )
+					return Error( "unsupported mask pixel format." );
+				const uint32_t w = block.width();
+				std::vector< float > row( w * 4 );
+				weights[ i ].resize( (size_t)w * w );
+				for ( uint32_t v = 0; v < w; ++v ) {
+					decoder( block.row( v ), w, row.data() );
+					for ( uint32_t u = 0; u < w; ++u )
+						weights[ i ][ (size_t)v * w + u ] = clampWeight( row[ u * 4 ] );
+				}
+			}
+			for ( int i = 0; i < 6; ++i )
+				weights_[ i ].swap( weights[ i ] );
+			updateMaskTiles();
+			return Error();
+		}
+
+		// }XN
+		void CubeDataFromImage::clearMask() {
+			for ( int i = 0; i < 6; ++i ) {
+				weights_[ i ].clear();
+				maskedTiles_[ i ].clear();
+			}
+		}
+
+		// }XN^CXV
+		void CubeDataFromImage::updateMaskTiles() {
+			const int32_t w = getTexelSize();
+			const int32_t tileNum = ( w + maskTileSize_g - 1 ) / maskTileSize_g;
+			for ( int i = 0; i < 6; ++i ) {
+				maskedTiles_[ i ].assign( tileNum * tileNum, 1 );
+				for ( int32_t v = 0; v < w; ++v ) {
+					for ( int32_t u = 0; u < w; ++u ) {
+						if ( weights_[ i ][ (size_t)v * w + u ] > 0.0f )
+							maskedTiles_[ i ][ ( v / maskTileSize_g ) * tileNum + u / maskTileSize_g ] = 0;
+					}
+				}
+			}
+		}
+
+		// }XNĂH
+		bool CubeDataFromImage::hasMask() const {
+			return weights_[ 0 ].empty() == false;
+		}
+
+		// wUVʒuɑ΂d݂擾
+		double CubeDataFromImage::getWeight( Face face, int32_t tu, int32_t tv ) const {
+			if ( weights_[ (int)face ].empty() )
+				return 1.0;
+			const int32_t w = images_[ (int)face ].width();
+			return weights_[ (int)face ][ (size_t)( tv % w ) * w + ( tu % w ) ];
+		}
+
+		// w̋`̈悪Să}XNĂH
+		//  ^CSɊ܂ޕ̓^CŁAȊO̓eNZPʂŔ
+		bool CubeDataFromImage::isRegionMasked( Face face, int32_t u, int32_t v, int32_t w, int32_t h ) const {
+			const auto &weights = weights_[ (int)face ];
+			if ( weights.empty() )
+				return false;
+			const int32_t size = getTexelSize();
+			const int32_t tileNum = ( size + maskTileSize_g - 1 ) / maskTileSize_g;
+			const int32_t u1 = ( u + w > size ? size : u + w );
+			const int32_t v1 = ( v + h > size ? size : v + h );
+			for ( int32_t ty = v / maskTileSize_g; ty * maskTileSize_g < v1; ++ty ) {
+				for ( int32_t tx = u / maskTileSize_g; tx * maskTileSize_g < u1; ++tx ) {
+					const int32_t x0 = tx * maskTileSize_g, y0 = ty * maskTileSize_g;
+					const int32_t x1 = ( x0 + maskTileSize_g > size ? size : x0 + maskTileSize_g );
+					const int32_t y1 = ( y0 + maskTileSize_g > size ? size : y0 + maskTileSize_g );
+					if ( maskedTiles_[ (int)face ][ ty * tileNum + tx ] )
+						continue;
+					if ( x0 >= u && y0 >= v && x1 <= u1 && y1 <= v1 )
+						return false;
+					for ( int32_t yy = ( y0 > v ? y0 : v ); yy < ( y1 < v1 ? y1 : v1 ); ++yy ) {
+						for ( int32_t xx = ( x0 > u ? x0 : u ); xx < ( x1 < u1 ? x1 : u1 ); ++xx ) {
+							if ( weights[ yy * size + xx ] > 0.0f )
+								return false;
+						}
+					}
+				}
+			}
+			return true;
+		}
+
 		// wUVʒuɑ΂l擾
 		RGBA CubeDataFromImage::getValue( Face face, int32_t tu, int32_t tv ) const {
-			const int32_t w = images_[ (int)face ].width();
+			const ImageBlock &image = images_[ (int)face ];
+			const int32_t w = image.width();
 			const int32_t u = tu % w;
 			const int32_t v = tv % w;
-			uint8_t bpc = images_[ (int)face ].bytePerColor();
-			uint8_t *p = images_[ (int)face ].p() + bpc * ( w * v + u );
-			uint8_t a = ( bpc == 3 ? 255 : p[ 3 ] );
-			return RGBA( p[ 0 ], p [ 1 ], p[ 2 ], a );
+			float rgba[ 4 ];
+			decodeRow( face, image.row( v ) + (size_t)image.bytePerColor() * u, 1, rgba );
+			auto toU8 = []( float f ) { return (uint8_t)( ( f < 0.0f ? 0.0f : ( f > 1.0f ? 1.0f : f ) ) * 255.0f + 0.5f ); };
+			return RGBA( toU8( rgba[ 0 ] ), toU8( rgba[ 1 ] ), toU8( rgba[ 2 ] ), toU8( rgba[ 3 ] ) );
+		}
+
+		// ws̒l𕂓_RGBAŎ擾
+		//  ɃsNZtH[}bgɑIϊ֐ŕϊ
+		void CubeDataFromImage::getRow( Face face, int32_t tv, float *rgba ) const {
+			const ImageBlock &image = images_[ (int)face ];
+			const int32_t w = image.width();
+			decodeRow( face, image.row( tv % w ), w, rgba );
+		}
+
+		// eNZ̕тjAȕ_RGBAɕϊ
+		//  ^̓e[uŁA_^͕ϊɐFԂfR[h
+		void CubeDataFromImage::decodeRow( Face face, const uint8_t *src, uint32_t num, float *rgba ) const {
+			const int f = (int)face;
+			if ( decodersLUT_[ f ] ) {
+				decodersLUT_[ f ]( src, num, decodeTables_[ f ]->data(), rgba );
+				return;
+			}
+			decoders_[ f ]( src, num, rgba );
+			ImageUtil::decodeColorSpaceRow( rgba, num, getDecodeFormat( f ) );
+		}
+
+		// fR[hɎgsNZtH[}bg擾
+		ImageBlock::PixelFormat CubeDataFromImage::getDecodeFormat( int face ) const {
+			ImageBlock::PixelFormat format = images_[ face ].format();
+			if ( isColorSpaceSet_ ) {
+				format.colorSpace_ = colorSpace_;
+				format.gamma_ = gamma_;
+			}
+			return format;
 		}
 
 		// }bṽeNZTCY擾
@@ -502,20 +1631,18 @@ namespace OX {
 
 		Error OutputResult::output( const Result& result, const char* filePath ) {
 			uint32_t maxLevel = result.getMaxLevel();
-			const auto& listR = result.getParamList( ColorType_R );
-			const auto& listG = result.getParamList( ColorType_G );
-			const auto& listB = result.getParamList( ColorType_B );
+			const uint32_t coefNum = result.getCoefNum();
 
-			if ( listR.size() == 0 ) {
+			if ( coefNum == 0 ) {
 				return Error( "no estimated parameter." );
 			}
 
 			Header header;
 			header.hederSize_ = sizeof( Header );
-			header.componentListNum_ = (uint32_t)listR.size();
+			header.componentListNum_ = coefNum;
 			header.containAlpha_ = 0;
 			header.maxOrderLevel_ = maxLevel;
-			header.reserved_ = 0;
+			header.basisType_ = (uint32_t)result.getBasisType();
 
 			uint32_t dataSize = sizeof( Header ) + header.componentListNum_ * 3 * sizeof( double );
 			uint8_t* dataBlock = new uint8_t[ dataSize ];
@@ -523,22 +1650,17 @@ namespace OX {
 			memcpy( p, &header, sizeof( header ) );
 			p += sizeof( header );
 
-			for ( uint32_t i = 0; i < listR.size(); ++i ) {
-				double v = listR[ i ].value();
-				memcpy( p, &v, sizeof( double ) );
-				p += sizeof( double );
-			}
-
-			for ( uint32_t i = 0; i < listG.size(); ++i ) {
-				double v = listG[ i ].value();
-				memcpy( p, &v, sizeof( double ) );
-				p += sizeof( double );
-			}
-
-			for ( uint32_t i = 0; i < listB.size(); ++i ) {
-				double v = listB[ i ].value();
-				memcpy( p, &v, sizeof( double ) );
-				p += sizeof( double );
+			// t@C͐F̕сBт̏ꍇ͂܂Ƃ߂ĕ
+			if ( result.getLayout() == CoefLayout_Planar ) {
+				memcpy( p, result.data(), (size_t)coefNum * 3 * sizeof( double ) );
+			} else {
+				for ( uint32_t c = 0; c < 3; ++c ) {
+					CoefSpan< const double > coefs = result.getCoefs( (ColorType)c );
+					for ( uint32_t i = 0; i < coefNum; ++i ) {
+						memcpy( p, &coefs[ i ], sizeof( double ) );
+						p += sizeof( double );
+					}
+				}
 			}
 
 			std::ofstream ofs( filePath, std::ios_base::out | std::ios_base::binary );
@@ -565,9 +1687,9 @@ namespace OX {
 
 		Error OutputResultText::output( const Result& result, const char* filePath ) {
 			uint32_t maxLevel = result.getMaxLevel();
-			const auto& listR = result.getParamList( ColorType_R );
-			const auto& listG = result.getParamList( ColorType_G );
-			const auto& listB = result.getParamList( ColorType_B );
+			const auto listR = result.getCoefs( ColorType_R );
+			const auto listG = result.getCoefs( ColorType_G );
+			const auto listB = result.getCoefs( ColorType_B );
 
 			if ( listR.size() == 0 ) {
 				return Error( "no estimated parameter." );
@@ -584,20 +1706,22 @@ namespace OX {
 				<< "max_order_level=" << maxLevel << std::endl
 				<< "component_list_num=" << listR.size() << std::endl
 				<< "contain_alpha=" << 0 << std::endl;
+			if ( result.getBasisType() == BasisType_HSH )
+				ofs << "basis=hsh" << std::endl;
 
 			ofs << "R" << std::endl;
 			for ( uint32_t i = 0; i < listR.size(); ++i ) {
-				double v = listR[ i ].value();
+				double v = listR[ i ];
 				ofs << std::setprecision( 15 ) << v << std::endl;
 			}
 			ofs << "G" << std::endl;
 			for ( uint32_t i = 0; i < listG.size(); ++i ) {
-				double v = listG[ i ].value();
+				double v = listG[ i ];
 				ofs << std::setprecision( 15 ) << v << std::endl;
 			}
 			ofs << "B" << std::endl;
 			for ( uint32_t i = 0; i < listB.size(); ++i ) {
-				double v = listB[ i ].value();
+				double v = listB[ i ];
 				ofs << std::setprecision( 15 ) << v << std::endl;
 			}
 			return Error();
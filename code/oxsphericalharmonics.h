@@ -5,6 +5,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <functional>
 #include "oximageutil.h"
 
@@ -34,7 +35,13 @@ namespace OX {
 			// ẘpxɑ΂l擾
 			//  th  : ܓxp(0`)
 			//  phi : oxp(0`2)
-			virtual double getValue( double th, double phi ) = 0;
+			virtual double getValue( double th, double phi ) const = 0;
+
+			// ẘpxɑ΂RGBl擾
+			//  łgetValue̒leFɐݒ
+			virtual void getRGB( double th, double phi, double &r, double &g, double &b ) const {
+				r = g = b = getValue( th, phi );
+			}
 		};
 
 		// L[u}bvf[^
@@ -57,6 +64,10 @@ namespace OX {
 			// ߂l : wUV܂ł̋
 			static double getPolar( Face face, int32_t w, int32_t tu, int32_t tv, double &th, double &phi );
 
+			// ʂ̒SƃeNZUAV̎擾
+			//  ʏ̓_ axis + s * u + t * v (s, t : eNZS-1`1ɐKUVʒu)BgetXYZƓ
+			static void getFaceBasis( Face face, double *axis, double *u, double *v );
+
 			CubeData() {}
 			virtual ~CubeData() {}
 
@@ -66,6 +77,21 @@ namespace OX {
 			// wUVʒuɑ΂l擾
 			virtual RGBA getValue( Face face, int32_t u, int32_t v ) const = 0;
 
+			// ws̒l𕂓_RGBAŎ擾
+			//  rgba : getTexelSize() * 4̏o͐
+			//  łgetValue̒l255Ŋ́BHDRf[^͎ŕ_̂܂ܕԂ
+			virtual void getRow( Face face, int32_t v, float *rgba ) const;
+
+			// }XNĂH
+			virtual bool hasMask() const { return false; }
+
+			// wUVʒuɑ΂d݂擾
+			//  ߂l : 0ŖȃeNZA1ŗLȃeNZ
+			virtual double getWeight( Face /*face*/, int32_t /*u*/, int32_t /*v*/ ) const { return 1.0; }
+
+			// w̋`̈悪Să}XNĂid݂0jH
+			virtual bool isRegionMasked( Face /*face*/, int32_t /*u*/, int32_t /*v*/, int32_t /*w*/, int32_t /*h*/ ) const { return false; }
+
 			// wUVʒuɑ΂XYZW擾
 			void getXYZ( Face face, int32_t tu, int32_t tv, double &x, double &y, double &z ) const;
 
@@ -74,6 +100,50 @@ namespace OX {
 			double getPolar( Face face, int32_t u, int32_t v, double &th, double &phi ) const;
 		};
 
+		// sKTvf[^
+		class SampleData {
+		public:
+			SampleData() {}
+			virtual ~SampleData() {}
+
+			// Tv擾
+			virtual uint32_t getSampleNum() const = 0;
+
+			// wTv̕擾iPʃxNgj
+			virtual void getDirection( uint32_t idx, double &x, double &y, double &z ) const = 0;
+
+			// wTv̒l擾
+			virtual void getValue( uint32_t idx, double &r, double &g, double &b ) const = 0;
+		};
+
+		// zŕێsKTvf[^
+		class SampleDataCustom : public SampleData {
+		public:
+			using SampleData::SampleData;
+			virtual ~SampleDataCustom() {}
+
+			// Tvǉ
+			//  th  : ܓxp(0`)
+			//  phi : oxp(0`2)
+			void addSample( double th, double phi, double r, double g, double b );
+
+			// TvSč폜
+			void clear();
+
+			// Tv擾
+			virtual uint32_t getSampleNum() const override;
+
+			// wTv̕擾iPʃxNgj
+			virtual void getDirection( uint32_t idx, double &x, double &y, double &z ) const override;
+
+			// wTv̒l擾
+			virtual void getValue( uint32_t idx, double &r, double &g, double &b ) const override;
+
+		private:
+			std::vector< double > dirs_;	// (xyz)
+			std::vector< double > values_;	// l(rgb)
+		};
+
 		// p[^
 		class Parameter {
 		public:
@@ -131,21 +201,113 @@ namespace OX {
 			ColorType_A
 		};
 
+		// ̎
+		enum BasisType {
+			BasisType_SH,	// ʒa֐iSj
+			BasisType_HSH,	// a֐i㔼 y >= 0 ̂݁j
+		};
+
+		// W̕
+		enum CoefLayout {
+			CoefLayout_Planar,		// FɑSĂ̌WׂiRRR...GGG...BBB...j
+			CoefLayout_Interleaved,	// WɐFׂiRGBRGB...j
+		};
+
+		// W̗̎Q
+		//  stride_size_̌WQƂBCoefLayout_Interleaved̏ꍇstride_3
+		template< class T >
+		struct CoefSpan {
+			T *data_ = 0;
+			uint32_t size_ = 0;
+			uint32_t stride_ = 1;
+
+			CoefSpan() {}
+			CoefSpan( T *data, uint32_t size, uint32_t stride ) : data_( data ), size_( size ), stride_( stride ) {}
+			template< class U >
+			CoefSpan( const CoefSpan< U > &r ) : data_( r.data_ ), size_( r.size_ ), stride_( r.stride_ ) {}	// constconst
+			T &operator []( uint32_t i ) const { return data_[ (uint64_t)i * stride_ ]; }
+			uint32_t size() const { return size_; }
+			bool isContiguous() const { return stride_ == 1; }
+		};
+
+		// F̃p[^Xg̎Q
+		//  W̗QƂA(l, m)Y狁߂ParameterlŕԂBResultύX܂ŗL
+		class ParamList {
+		public:
+			ParamList() {}
+			ParamList( const CoefSpan< const double > &coefs ) : coefs_( coefs ) {}
+
+			uint32_t size() const { return coefs_.size(); }
+			Parameter operator []( uint32_t idx ) const;
+
+		private:
+			CoefSpan< const double > coefs_;
+		};
+
 		// 茋
 		class Result {
 		public:
 			Result() {}
-			Result( uint32_t maxLevel, const std::vector< std::vector< Parameter > > &params ) : maxLevel_( maxLevel ), paramsVec_( params ) {}
+			Result( const Result &r );
+			Result( Result &&r );
 			~Result() {}
 
+			Result &operator =( const Result &r );
+			Result &operator =( Result &&r );
+
+			// oh̓v
+			//  GlM[͌W̓aiRGB̘ajŁA̗͂̓̊pϕƔׂ
+			struct BandStatistics {
+				double energy_ = 0.0;			// oȟW̃GlM[
+				double capturedRatio_ = 0.0;	// ̃oh܂łő͂̃GlM[̊
+				double residual_ = 0.0;			// ̃ohőł؂ꍇ̑RMS덷
+			};
+
+			// Wݒ
+			//  coefsR, G, B : (maxLevel + 1)^2̌WBscale|Č݂̕тŊi[
+			//  Ẅ̗͍ėp̂ŁAxŌJԂꍇ͊mۂsȂ
+			void set( uint32_t maxLevel, const double *coefsR, const double *coefsG, const double *coefsB, double scale, BasisType basis = BasisType_SH );
+
 			// Ԃ擾
 			ResultState getState() const;
 
 			// 莞̍őLevel擾
 			uint32_t getMaxLevel() const;
 
+			// ̎ނ擾
+			BasisType getBasisType() const;
+
+			// oh̓vݒ
+			//  stats : 肵ohixȈꍇ͏܂Łj
+			void setBandStatistics( const BandStatistics *stats, uint32_t num );
+
+			// oh̓v擾
+			//  voȂ̏ꍇ͋
+			const std::vector< BandStatistics > &getBandStatistics() const;
+
+			// W̕тݒ
+			//  i[ς݂̌W͕בւBCoefLayout_Planar
+			void setLayout( CoefLayout layout );
+
+			// W̕т擾
+			CoefLayout getLayout() const;
+
+			// F̌W̐擾
+			uint32_t getCoefNum() const;
+
+			// SĂ̌W擾
+			//  3 * getCoefNum()getLayout̕тŘAĎBAllocator::alignment_goCgEɑ
+			const double *data() const;
+			double *data();
+
+			// F̌W̗擾
+			//  ȐF̏ꍇ͋
+			CoefSpan< const double > getCoefs( ColorType ctype ) const;
+			CoefSpan< double > getCoefs( ColorType ctype );
+
 			// p[^Xg擾
-			const std::vector< Parameter > &getParamList( ColorType ctype ) const;
+			//  WQƂr[
+			ParamList getParamList( ColorType ctype ) const;
 
 			// wCfbNX̃p[^擾
 			//  ߂l : ȃp[^w肳ĂꍇParameter::isValidfalse
@@ -153,7 +315,11 @@ namespace OX {
 
 		private:
 			uint32_t maxLevel_ = 0;
-			std::vector< std::vector< Parameter > > paramsVec_;	// p[^iFʁj
+			uint32_t coefNum_ = 0;				// F̌W̐
+			CoefLayout layout_ = CoefLayout_Planar;
+			Buffer< double > coefs_;			// SĂ̐F̌W 3 * coefNum_
+			BasisType basis_ = BasisType_SH;	// ̎
+			std::vector< BandStatistics > bandStats_;	// oh̓v
 			ResultState state_ = ResultState::RS_NO_ESTIMATE;	// 
 		};
 
@@ -165,6 +331,21 @@ namespace OX {
 			Error( const std::string &reason ) : error_( true ), reason_( reason ) {}
 		};
 
+		class Reconstructor;
+
+		// ƍč\̍Ɨ̈
+		//  lAWAs̒lAč\̍Ɨ̈ێAĂяoԂŎg
+		//  xƖʃTCYŌJԂꍇA2ڈȍ~͊mۂsȂič\threadNum_1̏ꍇjBXbhɕʂ̍Ɨ̈g
+		struct Workspace {
+			Buffer< double > basis_;	// 1̊l ( level + 1 )^2
+			Buffer< double > coefs_;	// F̌W 3 * ( level + 1 )^2
+			Buffer< double > gram_;		// ŏ␳̃Os
+			Buffer< float > rows_;		// ǂݍ񂾍sAč\sRGBA
+			std::vector< Result::BandStatistics > bandStats_;	// oh̓v
+			uint32_t threadNum_ = 0;	// č\̃XbhB0Ńn[hEFÃXbh
+			std::shared_ptr< Reconstructor > reconstructor_;	// č\iɍ쐬j
+		};
+
 		// x[X
 		class Estimater {
 		public:
@@ -184,19 +365,133 @@ namespace OX {
 			using Estimater::Estimater;
 			virtual ~SphereEstimater() {}
 
+			// ϓ_ݒ
+			//  thetaNum : ƕGauss-Legendre_iband levelȏłband limitedȊ֐ɑ΂j
+			//  phiNum   : ӕ̓Ԋu_i2 * level + 1ȏłband limitedȊ֐ɑ΂j
+			void setQuadrature( uint32_t thetaNum, uint32_t phiNum );
+
 			// 
 			//  ߂l : G[ꍇ͗L񂪕Ԃ
 			Error estimate( const SphereData *sphere );
+
+			// 
+			//  ͊֐Gauss-Legendre x ԊűςŎˉe
+			Error estimate( const SphereData *sphere, Result &res );
+
+		private:
+			uint32_t thetaNum_ = 32;
+			uint32_t phiNum_ = 64;
+			std::vector< double > nodes_;	// cosƂGauss-Legendre_
+			std::vector< double > weights_;	// Gauss-Legendred
 		};
 
 		// L[uf[^̃p[^
 		class CubeEstimater : public Estimater {
 		public:
+			// }XNŌ̊p̕␳@
+			enum MaskCorrection {
+				MaskCorrection_None,			// ␳Ȃi}XN0j
+				MaskCorrection_Renormalize,		// Lȗ̊pőSɐK
+				MaskCorrection_LeastSquares,	// LȃeNẐ݂ōŏ搄
+			};
+
 			using Estimater::Estimater;
 			virtual ~CubeEstimater() {}
 
+			// }XN̕␳@ݒ
+			//  lambda : MaskCorrection_LeastSquares̐W
+			void setMaskCorrection( MaskCorrection correction, double lambda = 1.0e-4 );
+
+			// }XN̕␳@擾
+			MaskCorrection getMaskCorrection() const;
+
+			// xIݒ
+			//  RXgN^maxLevelƂđSohˉeAoh1Ȃ
+			//  ڕŴǂ炩𖞂ŏ̃xőł؂BI񂾃xResult::getMaxLevelœ
+			//  errorTarget  : ł؂̑RMS덷̖ڕWB0ȉŎgȂ
+			//  energyTarget : ͂̃GlM[̖̊ڕWi0`1jB0ȉŎgȂ
+			//  0ȉ̏ꍇ͏̃xŐ肷ij
+			//  }XNMaskCorrection_Renormalizeŕ␳ꍇA덷ƃGlM[̊͗Lȗ̊pO}ߎɂȂ
+			void setAutoLevel( double errorTarget, double energyTarget );
+
+			// xIL
+			bool isAutoLevel() const;
+
 			// 
+			//  }XNL[uf[^̏ꍇAd݂0̃eNZƑSă}XNꂽ^C͏Ȃ
+			//  oh̓vResultɐݒ肷
 			Error estimate( const CubeData *cube, Result &res, const std::function< void( uint64_t count, uint64_t procCount ) > &proc );
+
+			// Ɨ̈g񂵂Đ
+			//  res͊̃p[^Xg̗̈ɏ
+			Error estimate( const CubeData *cube, Result &res, const std::function< void( uint64_t count, uint64_t procCount ) > &proc, Workspace &workspace );
+
+		private:
+			MaskCorrection maskCorrection_ = MaskCorrection_Renormalize;
+			double maskLambda_ = 1.0e-4;
+			double errorTarget_ = 0.0;
+			double energyTarget_ = 0.0;
+		};
+
+		// 㔼̃L[uf[^̔a֐p[^
+		//  㔼iY+ĵ݂ɒlf[^𔼋ŐKȊŎˉe
+		//  Y-ʂƑʂ̉͏Ȃ߁AeNZ͑S̔ƂȂ
+		class HemisphereCubeEstimater : public Estimater {
+		public:
+			using Estimater::Estimater;
+			virtual ~HemisphereCubeEstimater() {}
+
+			// 
+			//  }XNL[uf[^̏ꍇAd݂0̃eNZ͏Ȃ
+			Error estimate( const CubeData *cube, Result &res, const std::function< void( uint64_t count, uint64_t procCount ) > &proc );
+
+			// Ɨ̈g񂵂Đ
+			Error estimate( const CubeData *cube, Result &res, const std::function< void( uint64_t count, uint64_t procCount ) > &proc, Workspace &workspace );
+		};
+
+		// sKTv̍ŏɂp[^
+		//  ̃OsRXL[ATv̏WL[ɃLbVB
+		//  Wɑ΂2ڈȍ~͍̐sxNgςƎOps݂̋̂ƂȂB
+		class LeastSquaresEstimater : public Estimater {
+		public:
+			//  lambda : WBband lɑ΂lambda * (l(l+1))^2 ΊpɉZ
+			//           setMaskCorrectionƓ1e-4BTv֐菭ȂĂB0ŐȂ
+			LeastSquaresEstimater( uint32_t maxLevel, double lambda = 1.0e-4 );
+			virtual ~LeastSquaresEstimater();
+
+			// 
+			//  ߂l : TvsĂčs񂪐lɂȂȂꍇ̓G[
+			Error estimate( const SampleData *samples, Result &res );
+
+			// W擾
+			double getLambda() const;
+
+			static const size_t defaultMaxCacheNum_g = 8;	// LbV镪ʂ̊̍ő吔
+
+			// LbVĂ镪ʂ̐擾
+			size_t getCacheNum() const;
+
+			// LbV镪ʂ̍ő吔ݒ
+			//  ͍łgĂȂ̂jB0ŃLbVȂ
+			void setMaxCacheNum( size_t num );
+
+			// LbV镪ʂ̍ő吔擾
+			size_t getMaxCacheNum() const;
+
+			// LbVj
+			void clearCache();
+
+		private:
+			struct Factorization;
+
+			// ʂnumȉɂȂ܂ōłgĂȂ̂j
+			void trimCache( size_t num );
+
+			double lambda_ = 1.0e-4;
+			std::map< uint64_t, std::vector< std::shared_ptr< Factorization > > > cache_;	// W̃nbV -> 
+			size_t cacheNum_ = 0;
+			size_t maxCacheNum_ = defaultMaxCacheNum_g;
+			uint64_t useCount_ = 0;		// gp̃JE^
 		};
 
 		// CubeMapC[WCubeData
@@ -209,14 +504,97 @@ namespace OX {
 			//  fileNames : 6ʂ̃t@C(EAAOAAȀ)
 			Error initialize( const std::vector< std::string > &fileNames );
 
+			// ImageBlock珉
+			//  images : 6ʂImageBlock(т̓t@CƓ)BImageBlockRef̏ꍇ͎QƐ𕡐Ȃ
+			Error initialize( const ImageBlock *images );
+
+			// Ăяõ珉
+			//  faces  : 6ʂ̐擪AhX(т̓t@CƓ)
+			//  width  : ʂ̃eNZ
+			//  pitch  : 1s̃oCgB0̏ꍇwidth * format.bytePerColor()
+			//  format : sNZtH[}bgBsetColorSpaceĂłȂꍇformat̐FԂŃfR[h
+			//  t@C̓o͂ɎQƂ̂ŁA͎gI܂ŌĂяoŕێ
+			Error initialize( const void *const *faces, uint32_t width, uint64_t pitch, const ImageBlock::PixelFormat &format );
+
+			// ͂̐FԂݒ
+			//  colorSpace : 摜̒l̐FԁBjAlɕϊĂ琄肷
+			//  gamma      : ColorSpace_Gamma̎w
+			//  Ă΂Ȃꍇ͖ʂImageBlock̃sNZtH[}bg̐FԂgit@Cǂ񂾉摜̓jAj
+			//  ^̉摜̓e[učs̓ǂݍ݂ƓɕϊBinitializȇOǂŐݒ肵Ăǂ
+			void setColorSpace( ImageBlock::ColorSpace colorSpace, float gamma = 2.2f );
+
+			// kfR[hݒ
+			//  maxLevel : 肷ő僌xB̒lŖij
+			//  k̖ʂ̕minReducedWidth( maxLevel )ȏƂȂő̏k(1/2, 1/4, 1/8)œǂݍ
+			//  JPEG̏ꍇ̂ݗLŁADCTW̒悾ŃfR[hi1/8DCŴ݁j
+			//  擪ȊO̖ʂkfR[hłȂ`̏ꍇ͓{œǂݍł畽ςŏk
+			//  initializȇOɐݒ肷
+			void setReducedDecode( int32_t maxLevel );
+
+			// ǂݍݎ̏k擾
+			uint32_t getDecodeScale() const;
+
+			// kfR[hŋeŏ̖ʂ̕
+			static uint32_t minReducedWidth( int32_t maxLevel );
+
+			// At@l}XNƂĎgp
+			//  At@l0̃eNZ𖳌ƂA0`1ɐAt@ld݂Ƃ
+			Error setMaskFromAlpha();
+
+			// }XN摜ݒ
+			//  fileNames : 6ʂ̃}XN摜t@C(тinitializeƓ)B0`1ɐ擪`l̒ld݂Ƃ
+			//  kfR[hꍇÃTCỸ}XN͕ςŏk
+			Error setMaskFromFiles( const std::vector< std::string > &fileNames );
+
+			// }XN
+			void clearMask();
+
 			// wUVʒuɑ΂l擾
+			//  _̉摜0`1ɃNv
 			virtual RGBA getValue( Face face, int32_t u, int32_t v ) const;
 
+			// ws̒l𕂓_RGBAŎ擾
+			virtual void getRow( Face face, int32_t v, float *rgba ) const override;
+
 			// }bṽeNZTCY擾
 			virtual uint32_t getTexelSize() const override;
 
+			// }XNĂH
+			virtual bool hasMask() const override;
+
+			// wUVʒuɑ΂d݂擾
+			virtual double getWeight( Face face, int32_t u, int32_t v ) const override;
+
+			// w̋`̈悪Să}XNĂH
+			virtual bool isRegionMasked( Face face, int32_t u, int32_t v, int32_t w, int32_t h ) const override;
+
 		private:
+			// s̕ϊ֐XV
+			Error updateDecoders();
+
+			// fR[hɎgsNZtH[}bg擾
+			//  setColorSpaceŐݒ肵ꍇ͂̐FԁAłȂΖʂ̉摜̐F
+			ImageBlock::PixelFormat getDecodeFormat( int face ) const;
+
+			// eNZ̕тjAȕ_RGBAɕϊ
+			void decodeRow( Face face, const uint8_t *src, uint32_t num, float *rgba ) const;
+
+			// }XN^CXV
+			void updateMaskTiles();
+
+			static const int32_t maskTileSize_g = 16;	// }XN^C̕ӂ̃eNZ
+
 			ImageBlock images_[ 6 ];
+			ImageUtil::RowDecoder decoders_[ 6 ] = {};	// ʖ̃sNZtH[}bgɑ΂s̕ϊ֐
+			ImageUtil::RowDecoderLUT decodersLUT_[ 6 ] = {};	// ʖ̃e[ut̍s̕ϊ֐
+			std::shared_ptr< std::vector< float > > decodeTables_[ 6 ];	// ʖ̐FԂ̃fR[he[uijȀꍇ͋j
+			ImageBlock::ColorSpace colorSpace_ = ImageBlock::ColorSpace_Linear;
+			float gamma_ = 2.2f;
+			bool isColorSpaceSet_ = false;	// setColorSpaceŐFԂݒ肵H
+			int32_t reducedLevel_ = -1;
+			uint32_t decodeScale_ = 1;
+			std::vector< float > weights_[ 6 ];			// eNZ̏d݁iŃ}XNj
+			std::vector< uint8_t > maskedTiles_[ 6 ];	// ^CSă}XNĂ1
 		};
 
 		// p[^o
@@ -232,7 +610,7 @@ namespace OX {
 				uint32_t maxOrderLevel_ = 0;
 				uint32_t componentListNum_ = 0;	// eF̃Xg
 				uint32_t containAlpha_ = 0;		// ꍇ1
-				uint32_t reserved_ = 0;			// \̈
+				uint32_t basisType_ = 0;		// ̎ށiBasisTypeB`̗\̈0͋ʒa֐j
 			};
 		};
 
@@ -246,13 +624,51 @@ namespace OX {
 		// ʒa֐Q쐬
 		std::vector< std::function< double( double th, double phi )> > createSphericalHarmonicsFuncs( uint32_t level );
 
+		// w̋ʒa֐lSĎZo
+		//  x, y, z : PʃxNgith = acos(y), phi = atan2(z, x)j
+		//  out     : (level + 1)^2̏o͐BтParameter::toIdxɏ]
+		void evalSphericalHarmonics( uint32_t level, double x, double y, double z, double *out );
+		void evalSphericalHarmonics( uint32_t level, double th, double phi, double *out );
+
+		// w̔a֐lSĎZo
+		//  P_l_m(2cos(th) - 1)p㔼(y >= 0)ŐKȊ
+		//  x, y, z : PʃxNgiy >= 0j
+		//  out     : (level + 1)^2̏o͐BтParameter::toIdxɏ]
+		void evalHemisphericalHarmonics( uint32_t level, double x, double y, double z, double *out );
+
+		// 茋ʂ̊Ŏẘ֐lSĎZo
+		//  a֐ŉ̏̕ꍇ͑S0
+		void evalBasis( const Result &res, double x, double y, double z, double *out );
+
 		// p[^L[u}bv쐬
 		enum CubeMapType {
 			Horizontal_Cross,	// NX
-			Vertical_Cross,		// cNX
+			Vertical_Cross,		// cNXiZ-180x]j
 			Separable,			// 6ʕ
+			Horizontal_Strip,	// iX+, X-, Y+, Y-, Z+, Z-̏j
+			Vertical_Strip,		// ciт͉Ɠj
 		};
-		std::vector< ImageBlock > createCubeMapFromParameters( const Result &res, uint32_t width, CubeMapType mapType, const std::function< void( uint64_t count, uint64_t procCount ) > &proc );
+		//  ʂ͏o͉摜̔zuʒuɒڏށBSeparableȊO1̉摜ԂAʂ̖0
+		//  type       : o͉摜̐̌^B_^̏ꍇ͏NvȂ
+		//  colorSpace : o͉摜̐FԁBjAȕlGR[hď
+		//  gamma      : ColorSpace_Gamma̎w
+		std::vector< ImageBlock > createCubeMapFromParameters( const Result &res, uint32_t width, CubeMapType mapType, const std::function< void( uint64_t count, uint64_t procCount ) > &proc, ImageBlock::ComponentType type = ImageBlock::ComponentType_U8, ImageBlock::ColorSpace colorSpace = ImageBlock::ColorSpace_Linear, float gamma = 2.2f );
+
+		// Ɨ̈Əo͐g񂵂ăL[u}bv쐬
+		//  out    : Ȍo͂nƁATCYƃtH[}bg̉摜ɂ̂܂܏ށi摜LĂꍇ͋Lj
+		//  ߂l : ΉĂȂtH[}bg̏ꍇfalse
+		bool createCubeMapFromParameters( const Result &res, uint32_t width, CubeMapType mapType, const std::function< void( uint64_t count, uint64_t procCount ) > &proc, Workspace &workspace, std::vector< ImageBlock > &out, ImageBlock::ComponentType type = ImageBlock::ComponentType_U8, ImageBlock::ColorSpace colorSpace = ImageBlock::ColorSpace_Linear, float gamma = 2.2f );
+
+		// p[^琳~}@iܓxoxj̉摜쐬
+		//   = atan2(z, x)0`2΁Ac = acos(y)0`΁i[Y+j
+		//  sɃWh֐1x]AsmɂĂ̘aō̂ő傫ȉ摜ły
+		//  typeAcolorSpaceAgammacreateCubeMapFromParametersƓ
+		ImageBlock createEquirectFromParameters( const Result &res, uint32_t width, uint32_t height, const std::function< void( uint64_t count, uint64_t procCount ) > &proc, ImageBlock::ComponentType type = ImageBlock::ComponentType_U8, ImageBlock::ColorSpace colorSpace = ImageBlock::ColorSpace_Linear, float gamma = 2.2f );
+
+		// Ɨ̈Əo͐g񂵂Đ~}@̉摜쐬
+		//  out    : Ȍo͂nƁATCYƃtH[}bg̉摜ɂ̂܂܏
+		//  ߂l : ΉĂȂtH[}bg̏ꍇfalse
+		bool createEquirectFromParameters( const Result &res, uint32_t width, uint32_t height, const std::function< void( uint64_t count, uint64_t procCount ) > &proc, Workspace &workspace, ImageBlock &out, ImageBlock::ComponentType type = ImageBlock::ComponentType_U8, ImageBlock::ColorSpace colorSpace = ImageBlock::ColorSpace_Linear, float gamma = 2.2f );
 	}
 }
 
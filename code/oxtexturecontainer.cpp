@@ -0,0 +1,668 @@
+#include "oxtexturecontainer.h"
+#include "oxblockcompression.h"
+#include <string.h>
+#include <sstream>
+#include <algorithm>
+#include <math.h>
+#include <fstream>
+
+namespace OX {
+	namespace {
+		uint32_t read32( const uint8_t *p ) {
+			uint32_t v;
+			memcpy( &v, p, sizeof( v ) );
+			return v;
+		}
+
+		uint64_t read64( const uint8_t *p ) {
+			uint64_t v;
+			memcpy( &v, p, sizeof( v ) );
+			return v;
+		}
+
+		void write32( uint8_t *p, uint32_t v ) {
+			memcpy( p, &v, sizeof( v ) );
+		}
+
+		uint32_t makeFourCC( char a, char b, char c, char d ) {
+			return (uint32_t)(uint8_t)a | ( (uint32_t)(uint8_t)b << 8 ) | ( (uint32_t)(uint8_t)c << 16 ) | ( (uint32_t)(uint8_t)d << 24 );
+		}
+
+		const uint8_t ktxIdentifier_g[ 12 ] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+		const uint8_t ktx2Identifier_g[ 12 ] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+		typedef OX::ImageBlock IB;
+		typedef OX::SphericalHarmonics::TextureContainer TC;
+
+		// `̃tH[}bgʎqƂ̑Ή
+		struct FormatEntry {
+			uint32_t id_;
+			uint8_t channelNum_;
+			IB::ComponentType type_;
+			IB::ColorSpace colorSpace_;
+			TC::Compression compression_;
+		};
+
+		// DXGI_FORMAT
+		const FormatEntry dxgiFormats_g[] = {
+			{ 2,  4, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_None },	// R32G32B32A32_FLOAT
+			{ 6,  3, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_None },	// R32G32B32_FLOAT
+			{ 10, 4, IB::ComponentType_F16, IB::ColorSpace_Linear, TC::Compression_None },	// R16G16B16A16_FLOAT
+			{ 11, 4, IB::ComponentType_U16, IB::ColorSpace_Linear, TC::Compression_None },	// R16G16B16A16_UNORM
+			{ 28, 4, IB::ComponentType_U8,  IB::ColorSpace_Linear, TC::Compression_None },	// R8G8B8A8_UNORM
+			{ 29, 4, IB::ComponentType_U8,  IB::ColorSpace_SRGB,   TC::Compression_None },	// R8G8B8A8_UNORM_SRGB
+			{ 41, 1, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_None },	// R32_FLOAT
+			{ 54, 1, IB::ComponentType_F16, IB::ColorSpace_Linear, TC::Compression_None },	// R16_FLOAT
+			{ 56, 1, IB::ComponentType_U16, IB::ColorSpace_Linear, TC::Compression_None },	// R16_UNORM
+			{ 61, 1, IB::ComponentType_U8,  IB::ColorSpace_Linear, TC::Compression_None },	// R8_UNORM
+			{ 71, 4, IB::ComponentType_U8,  IB::ColorSpace_Linear, TC::Compression_BC1 },	// BC1_UNORM
+			{ 72, 4, IB::ComponentType_U8,  IB::ColorSpace_SRGB,   TC::Compression_BC1 },	// BC1_UNORM_SRGB
+			{ 95, 3, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_BC6H_UF16 },	// BC6H_UF16
+			{ 96, 3, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_BC6H_SF16 },	// BC6H_SF16
+		};
+
+		// `DDSFourCCiD3DFORMAT̐l܂ށj
+		const FormatEntry d3dFormats_g[] = {
+			{ 36,  4, IB::ComponentType_U16, IB::ColorSpace_Linear, TC::Compression_None },	// A16B16G16R16
+			{ 111, 1, IB::ComponentType_F16, IB::ColorSpace_Linear, TC::Compression_None },	// R16F
+			{ 113, 4, IB::ComponentType_F16, IB::ColorSpace_Linear, TC::Compression_None },	// A16B16G16R16F
+			{ 114, 1, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_None },	// R32F
+			{ 116, 4, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_None },	// A32B32G32R32F
+			{ 0x31545844, 4, IB::ComponentType_U8, IB::ColorSpace_Linear, TC::Compression_BC1 },	// 'DXT1'
+		};
+
+		// KTXglInternalFormat
+		const FormatEntry glFormats_g[] = {
+			{ 0x8051, 3, IB::ComponentType_U8,  IB::ColorSpace_Linear, TC::Compression_None },	// RGB8
+			{ 0x8054, 3, IB::ComponentType_U16, IB::ColorSpace_Linear, TC::Compression_None },	// RGB16
+			{ 0x8058, 4, IB::ComponentType_U8,  IB::ColorSpace_Linear, TC::Compression_None },	// RGBA8
+			{ 0x805B, 4, IB::ComponentType_U16, IB::ColorSpace_Linear, TC::Compression_None },	// RGBA16
+			{ 0x8229, 1, IB::ComponentType_U8,  IB::ColorSpace_Linear, TC::Compression_None },	// R8
+			{ 0x822A, 1, IB::ComponentType_U16, IB::ColorSpace_Linear, TC::Compression_None },	// R16
+			{ 0x822D, 1, IB::ComponentType_F16, IB::ColorSpace_Linear, TC::Compression_None },	// R16F
+			{ 0x822E, 1, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_None },	// R32F
+			{ 0x8814, 4, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_None },	// RGBA32F
+			{ 0x8815, 3, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_None },	// RGB32F
+			{ 0x881A, 4, IB::ComponentType_F16, IB::ColorSpace_Linear, TC::Compression_None },	// RGBA16F
+			{ 0x881B, 3, IB::ComponentType_F16, IB::ColorSpace_Linear, TC::Compression_None },	// RGB16F
+			{ 0x8C41, 3, IB::ComponentType_U8,  IB::ColorSpace_SRGB,   TC::Compression_None },	// SRGB8
+			{ 0x8C43, 4, IB::ComponentType_U8,  IB::ColorSpace_SRGB,   TC::Compression_None },	// SRGB8_ALPHA8
+			{ 0x83F0, 4, IB::ComponentType_U8,  IB::ColorSpace_Linear, TC::Compression_BC1 },	// COMPRESSED_RGB_S3TC_DXT1
+			{ 0x83F1, 4, IB::ComponentType_U8,  IB::ColorSpace_Linear, TC::Compression_BC1 },	// COMPRESSED_RGBA_S3TC_DXT1
+			{ 0x8C4C, 4, IB::ComponentType_U8,  IB::ColorSpace_SRGB,   TC::Compression_BC1 },	// COMPRESSED_SRGB_S3TC_DXT1
+			{ 0x8C4D, 4, IB::ComponentType_U8,  IB::ColorSpace_SRGB,   TC::Compression_BC1 },	// COMPRESSED_SRGB_ALPHA_S3TC_DXT1
+			{ 0x8E8E, 3, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_BC6H_SF16 },	// COMPRESSED_RGB_BPTC_SIGNED_FLOAT
+			{ 0x8E8F, 3, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_BC6H_UF16 },	// COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT
+		};
+
+		// KTX2VkFormat
+		const FormatEntry vkFormats_g[] = {
+			{ 9,   1, IB::ComponentType_U8,  IB::ColorSpace_Linear, TC::Compression_None },	// R8_UNORM
+			{ 15,  1, IB::ComponentType_U8,  IB::ColorSpace_SRGB,   TC::Compression_None },	// R8_SRGB
+			{ 23,  3, IB::ComponentType_U8,  IB::ColorSpace_Linear, TC::Compression_None },	// R8G8B8_UNORM
+			{ 29,  3, IB::ComponentType_U8,  IB::ColorSpace_SRGB,   TC::Compression_None },	// R8G8B8_SRGB
+			{ 37,  4, IB::ComponentType_U8,  IB::ColorSpace_Linear, TC::Compression_None },	// R8G8B8A8_UNORM
+			{ 43,  4, IB::ComponentType_U8,  IB::ColorSpace_SRGB,   TC::Compression_None },	// R8G8B8A8_SRGB
+			{ 70,  1, IB::ComponentType_U16, IB::ColorSpace_Linear, TC::Compression_None },	// R16_UNORM
+			{ 76,  1, IB::ComponentType_F16, IB::ColorSpace_Linear, TC::Compression_None },	// R16_SFLOAT
+			{ 84,  3, IB::ComponentType_U16, IB::ColorSpace_Linear, TC::Compression_None },	// R16G16B16_UNORM
+			{ 90,  3, IB::ComponentType_F16, IB::ColorSpace_Linear, TC::Compression_None },	// R16G16B16_SFLOAT
+			{ 91,  4, IB::ComponentType_U16, IB::ColorSpace_Linear, TC::Compression_None },	// R16G16B16A16_UNORM
+			{ 97,  4, IB::ComponentType_F16, IB::ColorSpace_Linear, TC::Compression_None },	// R16G16B16A16_SFLOAT
+			{ 100, 1, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_None },	// R32_SFLOAT
+			{ 106, 3, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_None },	// R32G32B32_SFLOAT
+			{ 109, 4, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_None },	// R32G32B32A32_SFLOAT
+			{ 131, 4, IB::ComponentType_U8,  IB::ColorSpace_Linear, TC::Compression_BC1 },	// BC1_RGB_UNORM_BLOCK
+			{ 132, 4, IB::ComponentType_U8,  IB::ColorSpace_SRGB,   TC::Compression_BC1 },	// BC1_RGB_SRGB_BLOCK
+			{ 133, 4, IB::ComponentType_U8,  IB::ColorSpace_Linear, TC::Compression_BC1 },	// BC1_RGBA_UNORM_BLOCK
+			{ 134, 4, IB::ComponentType_U8,  IB::ColorSpace_SRGB,   TC::Compression_BC1 },	// BC1_RGBA_SRGB_BLOCK
+			{ 143, 3, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_BC6H_UF16 },	// BC6H_UFLOAT_BLOCK
+			{ 144, 3, IB::ComponentType_F32, IB::ColorSpace_Linear, TC::Compression_BC6H_SF16 },	// BC6H_SFLOAT_BLOCK
+		};
+
+		template< size_t N >
+		const FormatEntry *findFormat( const FormatEntry ( &entries )[ N ], uint32_t id ) {
+			for ( size_t i = 0; i < N; ++i ) {
+				if ( entries[ i ].id_ == id )
+					return &entries[ i ];
+			}
+			return 0;
+		}
+	}
+
+	namespace SphericalHarmonics {
+
+		// t@CJ
+		Error TextureContainer::open( const char *filePath ) {
+			close();
+			std::shared_ptr< MappedFile > file = std::make_shared< MappedFile >();
+			if ( file->open( filePath ) == false ) {
+				std::stringstream ss;
+				ss << "failed to open file. [" << ( filePath ? filePath : "" ) << "]";
+				return Error( ss.str() );
+			}
+			file_ = file;
+
+			Error err;
+			const uint8_t *p = file_->data();
+			if ( file_->size() >= 128 && read32( p ) == makeFourCC( 'D', 'D', 'S', ' ' ) )
+				err = parseDDS();
+			else if ( file_->size() >= 64 && memcmp( p, ktxIdentifier_g, sizeof( ktxIdentifier_g ) ) == 0 )
+				err = parseKTX();
+			else if ( file_->size() >= 80 && memcmp( p, ktx2Identifier_g, sizeof( ktx2Identifier_g ) ) == 0 )
+				err = parseKTX2();
+			else
+				err = Error( "unknown container format." );
+			if ( err.error_ ) {
+				close();
+				return err;
+			}
+
+			// SĂ̖ʂt@CɎ܂Ă邩
+			for ( auto &s : surfaces_ ) {
+				const uint64_t offset = (uint64_t)( s.p_ - file_->data() );
+				if ( offset > file_->size() || s.size_ > file_->size() - offset ) {
+					close();
+					return Error( "container is truncated." );
+				}
+			}
+			return Error();
+		}
+
+		// 
+		void TextureContainer::close() {
+			file_.reset();
+			format_ = ImageBlock::PixelFormat();
+			compression_ = Compression_None;
+			mipNum_ = 0;
+			layerNum_ = 0;
+			surfaces_.clear();
+		}
+
+		// ʂ̃oCgƃsb`ݒ
+		void TextureContainer::setSurfaceSize( Surface &surface, uint32_t width, uint32_t height, uint32_t rowAlign ) const {
+			surface.width_ = width;
+			surface.height_ = height;
+			if ( compression_ != Compression_None ) {
+				const uint64_t blockByte = ( compression_ == Compression_BC1 ? 8 : 16 );
+				surface.pitch_ = ( ( width + 3 ) / 4 ) * blockByte;
+				surface.size_ = surface.pitch_ * ( ( height + 3 ) / 4 );
+				return;
+			}
+			const uint64_t rowByte = (uint64_t)width * format_.bytePerColor();
+			surface.pitch_ = ( rowByte + rowAlign - 1 ) / rowAlign * rowAlign;
+			surface.size_ = surface.pitch_ * height;
+		}
+
+		// ~bv𐧌Aʂ̍voCgt@CɎ܂ꍇ̂ݖʂ̔zm
+		//  ~bv1x1܂łfloor( log2( width ) ) + 1ɗ}
+		Error TextureContainer::allocateSurfaces( uint32_t width, uint32_t rowAlign ) {
+			uint32_t maxMipNum = 1;
+			while ( ( width >> maxMipNum ) > 0 )
+				++maxMipNum;
+			mipNum_ = std::min( mipNum_, maxMipNum );
+
+			const uint64_t fileByte = file_->size();
+			const uint64_t faceNum = (uint64_t)layerNum_ * 6;
+			uint64_t totalByte = 0;
+			for ( uint32_t mip = 0; mip < mipNum_; ++mip ) {
+				const uint32_t w = ( width >> mip ? width >> mip : 1 );
+				Surface s;
+				setSurfaceSize( s, w, 1, rowAlign );
+				const uint64_t rowNum = ( compression_ != Compression_None ? ( w + 3 ) / 4 : w );
+				if ( s.pitch_ == 0 || rowNum > fileByte / s.pitch_ )
+					return Error( "container is truncated." );
+				const uint64_t surfaceByte = s.pitch_ * rowNum;
+				if ( surfaceByte > ( fileByte - totalByte ) / faceNum )
+					return Error( "container is truncated." );
+				totalByte += surfaceByte * faceNum;
+			}
+			surfaces_.resize( (size_t)( faceNum * mipNum_ ) );
+			return Error();
+		}
+
+		// DDS
+		//  f[^͔zvfAʁA~bv̏ɕ
+		Error TextureContainer::parseDDS() {
+			const uint8_t *p = file_->data();
+			const uint32_t flags = read32( p + 8 );
+			const uint32_t height = read32( p + 12 );
+			const uint32_t width = read32( p + 16 );
+			const uint32_t mipCount = read32( p + 28 );
+			const uint32_t pfFlags = read32( p + 80 );
+			const uint32_t fourCC = read32( p + 84 );
+			const uint32_t bitCount = read32( p + 88 );
+			const uint32_t caps2 = read32( p + 112 );
+			uint64_t offset = 128;
+
+			const FormatEntry *entry = 0;
+			FormatEntry legacy = {};
+			bool isCube = false;
+			layerNum_ = 1;
+			if ( ( pfFlags & 0x4 ) && fourCC == makeFourCC( 'D', 'X', '1', '0' ) ) {
+				if ( file_->size() < 148 )
+					return Error( "container is truncated." );
+				entry = findFormat( dxgiFormats_g, read32( p + 128 ) );
+				isCube = ( read32( p + 136 ) & 0x4 ) != 0;	// D3D10_RESOURCE_MISC_TEXTURECUBE
+				layerNum_ = read32( p + 140 );
+				offset = 148;
+			} else {
+				if ( pfFlags & 0x4 ) {
+					// DDPF_FOURCC
+					entry = findFormat( d3dFormats_g, fourCC );
+				} else if ( ( pfFlags & 0x40 ) && read32( p + 92 ) == 0xff && read32( p + 96 ) == 0xff00 && read32( p + 100 ) == 0xff0000 ) {
+					// DDPF_RGBiRAGAB̏̂̂̂݁j
+					if ( bitCount == 32 || bitCount == 24 ) {
+						legacy = { 0, (uint8_t)( bitCount / 8 ), IB::ComponentType_U8, IB::ColorSpace_Linear, Compression_None };
+						entry = &legacy;
+					}
+				} else if ( ( pfFlags & 0x20000 ) && bitCount == 8 ) {
+					// DDPF_LUMINANCE
+					legacy = { 0, 1, IB::ComponentType_U8, IB::ColorSpace_Linear, Compression_None };
+					entry = &legacy;
+				}
+				isCube = ( caps2 & 0x200 ) && ( caps2 & 0xFC00 ) == 0xFC00;	// DDSCAPS2_CUBEMAPASĂ̖
+			}
+			if ( entry == 0 )
+				return Error( "unsupported DDS format." );
+			if ( isCube == false )
+				return Error( "DDS is not a cube map." );
+			if ( width != height || width == 0 || layerNum_ == 0 )
+				return Error( "invalid DDS size." );
+
+			format_ = ImageBlock::PixelFormat( entry->channelNum_, entry->type_, entry->colorSpace_ );
+			compression_ = entry->compression_;
+			mipNum_ = ( ( flags & 0x20000 ) && mipCount > 0 ? mipCount : 1 );	// DDSD_MIPMAPCOUNT
+			Error err = allocateSurfaces( width, 1 );
+			if ( err.error_ )
+				return err;
+			for ( uint32_t layer = 0; layer < layerNum_; ++layer ) {
+				for ( uint32_t face = 0; face < 6; ++face ) {
+					for ( uint32_t mip = 0; mip < mipNum_; ++mip ) {
+						Surface &s = surfaces_[ ( (uint64_t)layer * mipNum_ + mip ) * 6 + face ];
+						const uint32_t w = ( width >> mip ? width >> mip : 1 );
+						setSurfaceSize( s, w, w, 1 );
+						s.p_ = p + offset;
+						offset += s.size_;
+					}
+				}
+			}
+			return Error();
+		}
+
+		// KTX
+		//  f[^̓~bvɃC[WTCYuAzvfAʂ̏ɕԁBs4oCgE
+		Error TextureContainer::parseKTX() {
+			const uint8_t *p = file_->data();
+			if ( read32( p + 12 ) != 0x04030201 )
+				return Error( "KTX endianness is not supported." );
+			const FormatEntry *entry = findFormat( glFormats_g, read32( p + 28 ) );
+			const uint32_t width = read32( p + 36 );
+			const uint32_t height = read32( p + 40 );
+			const uint32_t arrayNum = read32( p + 48 );
+			const uint32_t faceNum = read32( p + 52 );
+			const uint32_t mipCount = read32( p + 56 );
+			const uint32_t kvByte = read32( p + 60 );
+			if ( entry == 0 )
+				return Error( "unsupported KTX format." );
+			if ( faceNum != 6 )
+				return Error( "KTX is not a cube map." );
+			if ( width != height || width == 0 )
+				return Error( "invalid KTX size." );
+
+			format_ = ImageBlock::PixelFormat( entry->channelNum_, entry->type_, entry->colorSpace_ );
+			compression_ = entry->compression_;
+			mipNum_ = ( mipCount > 0 ? mipCount : 1 );
+			layerNum_ = ( arrayNum > 0 ? arrayNum : 1 );
+			Error err = allocateSurfaces( width, 4 );
+			if ( err.error_ )
+				return err;
+			uint64_t offset = 64 + (uint64_t)kvByte;
+			for ( uint32_t mip = 0; mip < mipNum_; ++mip ) {
+				offset += 4;	// imageSize
+				for ( uint32_t layer = 0; layer < layerNum_; ++layer ) {
+					for ( uint32_t face = 0; face < 6; ++face ) {
+						Surface &s = surfaces_[ ( (uint64_t)layer * mipNum_ + mip ) * 6 + face ];
+						const uint32_t w = ( width >> mip ? width >> mip : 1 );
+						setSurfaceSize( s, w, w, 4 );
+						s.p_ = p + offset;
+						offset += ( s.size_ + 3 ) / 4 * 4;
+					}
+				}
+				offset = ( offset + 3 ) / 4 * 4;
+				if ( offset > file_->size() )
+					return Error( "container is truncated." );
+			}
+			return Error();
+		}
+
+		// KTX2
+		//  ~bv̈ʒu̓xCfbNXɏ]Bx͔zvfAʂ̏
+		Error TextureContainer::parseKTX2() {
+			const uint8_t *p = file_->data();
+			const FormatEntry *entry = findFormat( vkFormats_g, read32( p + 12 ) );
+			const uint32_t width = read32( p + 20 );
+			const uint32_t height = read32( p + 24 );
+			const uint32_t arrayNum = read32( p + 32 );
+			const uint32_t faceNum = read32( p + 36 );
+			const uint32_t levelCount = read32( p + 40 );
+			const uint32_t supercompression = read32( p + 44 );
+			if ( supercompression != 0 )
+				return Error( "KTX2 supercompression is not supported." );
+			if ( entry == 0 )
+				return Error( "unsupported KTX2 format." );
+			if ( faceNum != 6 )
+				return Error( "KTX2 is not a cube map." );
+			if ( width != height || width == 0 )
+				return Error( "invalid KTX2 size." );
+
+			format_ = ImageBlock::PixelFormat( entry->channelNum_, entry->type_, entry->colorSpace_ );
+			compression_ = entry->compression_;
+			mipNum_ = ( levelCount > 0 ? levelCount : 1 );
+			layerNum_ = ( arrayNum > 0 ? arrayNum : 1 );
+			Error err = allocateSurfaces( width, 1 );
+			if ( err.error_ )
+				return err;
+			if ( 80 + (uint64_t)mipNum_ * 24 > file_->size() )
+				return Error( "container is truncated." );
+			for ( uint32_t mip = 0; mip < mipNum_; ++mip ) {
+				uint64_t offset = read64( p + 80 + mip * 24 );
+				const uint64_t levelByte = read64( p + 80 + mip * 24 + 8 );
+				if ( offset > file_->size() || levelByte > file_->size() - offset )
+					return Error( "container is truncated." );
+				for ( uint32_t layer = 0; layer < layerNum_; ++layer ) {
+					for ( uint32_t face = 0; face < 6; ++face ) {
+						Surface &s = surfaces_[ ( (uint64_t)layer * mipNum_ + mip ) * 6 + face ];
+						const uint32_t w = ( width >> mip ? width >> mip : 1 );
+						setSurfaceSize( s, w, w, 1 );
+						s.p_ = p + offset;
+						offset += s.size_;
+					}
+				}
+			}
+			return Error();
+		}
+
+		// ʂ̃eNZ擾
+		uint32_t TextureContainer::getTexelSize( uint32_t mip ) const {
+			if ( mip >= mipNum_ )
+				return 0;
+			return surfaces_[ mip * 6 ].width_;
+		}
+
+		// ~bv擾
+		uint32_t TextureContainer::getMipNum() const {
+			return mipNum_;
+		}
+
+		// zvfiL[u}bv̐j擾
+		uint32_t TextureContainer::getLayerNum() const {
+			return layerNum_;
+		}
+
+		// sNZtH[}bg擾
+		const ImageBlock::PixelFormat &TextureContainer::getPixelFormat() const {
+			return format_;
+		}
+
+		// ubNk̎ނ擾
+		TextureContainer::Compression TextureContainer::getCompression() const {
+			return compression_;
+		}
+
+		// 1ʕ̃f[^擾
+		bool TextureContainer::getSurface( uint32_t layer, uint32_t mip, uint32_t face, Surface &surface ) const {
+			if ( layer >= layerNum_ || mip >= mipNum_ || face >= 6 )
+				return false;
+			surface = surfaces_[ ( (uint64_t)layer * mipNum_ + mip ) * 6 + face ];
+			return true;
+		}
+
+		// }bvt@C擾
+		const std::shared_ptr< MappedFile > &TextureContainer::getFile() const {
+			return file_;
+		}
+
+		// L[u}bvDDSŕۑ
+		Error TextureContainer::saveDDS( const char *filePath, uint32_t width, uint32_t mipNum, const ImageBlock::PixelFormat &format, const uint8_t *data, uint64_t size ) {
+			const FormatEntry *entry = 0;
+			for ( auto &e : dxgiFormats_g ) {
+				if ( e.compression_ == Compression_None && e.channelNum_ == format.channelNum_ && e.type_ == format.type_ && e.colorSpace_ == format.colorSpace_ ) {
+					entry = &e;
+					break;
+				}
+			}
+			if ( entry == 0 )
+				return Error( "unsupported DDS format." );
+			if ( mipNum > 32 )
+				return Error( "invalid DDS data." );
+			uint64_t dataByte = 0;
+			for ( uint32_t mip = 0; mip < mipNum; ++mip ) {
+				const uint64_t w = ( width >> mip ? width >> mip : 1 );
+				dataByte += w * w * format.bytePerColor() * 6;
+			}
+			if ( width == 0 || mipNum == 0 || data == 0 || size < dataByte )
+				return Error( "invalid DDS data." );
+
+			uint8_t header[ 148 ] = {};
+			write32( header, makeFourCC( 'D', 'D', 'S', ' ' ) );
+			write32( header + 4, 124 );
+			write32( header + 8, 0x1 | 0x2 | 0x4 | 0x8 | 0x1000 | 0x20000 );	// CAPSAHEIGHTAWIDTHAPITCHAPIXELFORMATAMIPMAPCOUNT
+			write32( header + 12, width );
+			write32( header + 16, width );
+			write32( header + 20, width * format.bytePerColor() );
+			write32( header + 28, mipNum );
+			write32( header + 76, 32 );
+			write32( header + 80, 0x4 );	// DDPF_FOURCC
+			write32( header + 84, makeFourCC( 'D', 'X', '1', '0' ) );
+			write32( header + 108, 0x1000 | 0x8 | ( mipNum > 1 ? 0x400000 : 0 ) );	// TEXTUREACOMPLEXAMIPMAP
+			write32( header + 112, 0x200 | 0xFC00 );	// CUBEMAPASĂ̖
+			write32( header + 128, entry->id_ );
+			write32( header + 132, 3 );		// D3D10_RESOURCE_DIMENSION_TEXTURE2D
+			write32( header + 136, 0x4 );	// D3D10_RESOURCE_MISC_TEXTURECUBE
+			write32( header + 140, 1 );
+
+			std::ofstream ofs( filePath, std::ios_base::out | std::ios_base::binary );
+			if ( ofs.is_open() == false ) {
+				std::stringstream ss;
+				ss << "failed to open output file. [" << ( filePath ? filePath : "" ) << "]";
+				return Error( ss.str() );
+			}
+			ofs.write( (const char*)header, sizeof( header ) );
+			ofs.write( (const char*)data, dataByte );
+			if ( ofs.good() == false )
+				return Error( "failed to write DDS." );
+			return Error();
+		}
+
+
+
+		// 
+		Error CubeDataFromContainer::initialize( const TextureContainer &container, uint32_t layer, uint32_t mip ) {
+			if ( container.getFile() == 0 )
+				return Error( "container is not opened." );
+			if ( layer >= container.getLayerNum() || mip >= container.getMipNum() )
+				return Error( "layer or mip is out of range." );
+
+			format_ = container.getPixelFormat();
+			compression_ = container.getCompression();
+			decoder_ = ImageUtil::getRowDecoder( format_ );
+			if ( decoder_ == 0 )
+				return Error( "unsupported pixel format." );
+			decoderLUT_ = 0;
+			decodeTable_.reset();
+			if ( compression_ == TextureContainer::Compression_None && format_.colorSpace_ != ImageBlock::ColorSpace_Linear ) {
+				decoderLUT_ = ImageUtil::getRowDecoderLUT( format_ );
+				if ( decoderLUT_ )
+					decodeTable_ = std::make_shared< std::vector< float > >( ImageUtil::createDecodeTable( format_ ) );
+			}
+			for ( uint32_t f = 0; f < 6; ++f )
+				container.getSurface( layer, mip, f, surfaces_[ f ] );
+			file_ = container.getFile();
+			return Error();
+		}
+
+		// wUVʒuɑ΂l擾
+		RGBA CubeDataFromContainer::getValue( Face face, int32_t tu, int32_t tv ) const {
+			const TextureContainer::Surface &s = surfaces_[ (int)face ];
+			const int32_t w = s.width_;
+			float rgba[ 4 ];
+			if ( compression_ != TextureContainer::Compression_None ) {
+				float block[ 16 * 4 ];
+				decodeBlock( getBlock( face, ( tu % w ) / 4, ( tv % w ) / 4 ), block );
+				memcpy( rgba, &block[ ( ( tv % w ) % 4 * 4 + ( tu % w ) % 4 ) * 4 ], sizeof( rgba ) );
+			} else {
+				decodeRow( s.p_ + s.pitch_ * ( tv % w ) + (size_t)format_.bytePerColor() * ( tu % w ), 1, rgba );
+			}
+			auto toU8 = []( float f ) { return (uint8_t)( ( f < 0.0f ? 0.0f : ( f > 1.0f ? 1.0f : f ) ) * 255.0f + 0.5f ); };
+			return RGBA( toU8( rgba[ 0 ] ), toU8( rgba[ 1 ] ), toU8( rgba[ 2 ] ), toU8( rgba[ 3 ] ) );
+		}
+
+		// ws̒l𕂓_RGBAŎ擾
+		void CubeDataFromContainer::getRow( Face face, int32_t tv, float *rgba ) const {
+			const TextureContainer::Surface &s = surfaces_[ (int)face ];
+			const int32_t w = s.width_;
+			if ( compression_ != TextureContainer::Compression_None ) {
+				const int32_t v = tv % w;
+				float block[ 16 * 4 ];
+				for ( int32_t bx = 0; bx * 4 < w; ++bx ) {
+					decodeBlock( getBlock( face, bx, v / 4 ), block );
+					const int32_t num = ( w - bx * 4 < 4 ? w - bx * 4 : 4 );
+					memcpy( rgba + bx * 16, &block[ ( v % 4 ) * 16 ], sizeof( float ) * 4 * num );
+				}
+				return;
+			}
+			decodeRow( s.p_ + s.pitch_ * ( tv % w ), w, rgba );
+		}
+
+		// eNZ̕тjAȕ_RGBAɕϊ
+		void CubeDataFromContainer::decodeRow( const uint8_t *src, uint32_t num, float *rgba ) const {
+			if ( decoderLUT_ ) {
+				decoderLUT_( src, num, decodeTable_->data(), rgba );
+				return;
+			}
+			decoder_( src, num, rgba );
+			ImageUtil::decodeColorSpaceRow( rgba, num, format_ );
+		}
+
+		// }bṽeNZTCY擾
+		uint32_t CubeDataFromContainer::getTexelSize() const {
+			return surfaces_[ 0 ].width_;
+		}
+
+		// sNZtH[}bg擾
+		const ImageBlock::PixelFormat &CubeDataFromContainer::getPixelFormat() const {
+			return format_;
+		}
+
+		// ubNk̎ނ擾
+		TextureContainer::Compression CubeDataFromContainer::getCompression() const {
+			return compression_;
+		}
+
+		// kubN擾
+		const uint8_t *CubeDataFromContainer::getBlock( Face face, int32_t bx, int32_t by ) const {
+			const TextureContainer::Surface &s = surfaces_[ (int)face ];
+			const uint32_t blockByte = ( compression_ == TextureContainer::Compression_BC1 ? 8 : 16 );
+			return s.p_ + s.pitch_ * by + (size_t)blockByte * bx;
+		}
+
+		// kubNjAȕ_RGBAɓWJ
+		void CubeDataFromContainer::decodeBlock( const uint8_t *block, float *rgba ) const {
+			if ( compression_ == TextureContainer::Compression_BC1 ) {
+				BlockCompression::decodeBC1( block, rgba );
+				ImageUtil::decodeColorSpaceRow( rgba, 16, format_ );
+			} else {
+				BlockCompression::decodeBC6H( block, compression_ == TextureContainer::Compression_BC6H_SF16, rgba );
+			}
+		}
+
+
+
+		// 
+		Error CompressedCubeEstimater::estimate( const CubeDataFromContainer *cube, Result &res, const std::function< void( uint64_t count, uint64_t procCount ) > &proc ) {
+			if ( cube == 0 )
+				return Error( "Null object" );
+			const TextureContainer::Compression compression = cube->getCompression();
+			if ( compression == TextureContainer::Compression_None ) {
+				CubeEstimater est( maxLevel_ );
+				return est.estimate( cube, res, proc );
+			}
+
+			const int32_t width = cube->getTexelSize();
+			const int32_t blockNum = ( width + 3 ) / 4;
+			const uint32_t fnum = ( maxLevel_ + 1 ) * ( maxLevel_ + 1 );
+			std::vector< double > coefs( fnum * 3, 0.0 );
+			double *coefsR = &coefs[ 0 ];
+			double *coefsG = &coefs[ fnum ];
+			double *coefsB = &coefs[ fnum * 2 ];
+			std::vector< double > yvals( fnum );
+			std::vector< double > sums( 4 * fnum );
+			const bool isSRGB = ( cube->getPixelFormat().colorSpace_ != ImageBlock::ColorSpace_Linear );
+			uint64_t count = 0;
+			const uint64_t procCount = 6ull * blockNum * blockNum;
+			for ( int32_t f = 0; f < CubeData::Face::Face_Num; ++f ) {
+				const CubeData::Face face = (CubeData::Face)f;
+				for ( int32_t by = 0; by < blockNum; ++by ) {
+					for ( int32_t bx = 0; bx < blockNum; ++bx ) {
+						const uint8_t *block = cube->getBlock( face, bx, by );
+						float palette[ 16 ];
+						uint8_t indices[ 16 ];
+						float rgba[ 16 * 4 ];
+						if ( compression == TextureContainer::Compression_BC1 ) {
+							BlockCompression::decodeBC1Palette( block, palette, indices );
+							if ( isSRGB )
+								ImageUtil::decodeColorSpaceRow( palette, 4, cube->getPixelFormat() );
+							std::fill( sums.begin(), sums.end(), 0.0 );
+						} else {
+							BlockCompression::decodeBC6H( block, compression == TextureContainer::Compression_BC6H_SF16, rgba );
+						}
+
+						for ( int32_t t = 0; t < 16; ++t ) {
+							const int32_t u = bx * 4 + t % 4;
+							const int32_t v = by * 4 + t / 4;
+							if ( u >= width || v >= width )
+								continue;
+							double x, y, z;
+							CubeData::getXYZ( face, width, u, v, x, y, z );
+							const double l = sqrt( x * x + y * y + z * z );
+							const double dw = 1.0 / ( l * l * l );
+							evalSphericalHarmonics( maxLevel_, x / l, y / l, z / l, yvals.data() );
+							if ( compression == TextureContainer::Compression_BC1 ) {
+								// pbg̃CfbNXɊlv
+								double *s = &sums[ indices[ t ] * fnum ];
+								for ( uint32_t i = 0; i < fnum; ++i )
+									s[ i ] += yvals[ i ] * dw;
+							} else {
+								const double r = rgba[ t * 4 + 0 ] * dw, g = rgba[ t * 4 + 1 ] * dw, b = rgba[ t * 4 + 2 ] * dw;
+								for ( uint32_t i = 0; i < fnum; ++i ) {
+									coefsR[ i ] += r * yvals[ i ];
+									coefsG[ i ] += g * yvals[ i ];
+									coefsB[ i ] += b * yvals[ i ];
+								}
+							}
+						}
+
+						if ( compression == TextureContainer::Compression_BC1 ) {
+							for ( int32_t k = 0; k < 4; ++k ) {
+								const double *s = &sums[ k * fnum ];
+								const double r = palette[ k * 4 + 0 ], g = palette[ k * 4 + 1 ], b = palette[ k * 4 + 2 ];
+								for ( uint32_t i = 0; i < fnum; ++i ) {
+									coefsR[ i ] += r * s[ i ];
+									coefsG[ i ] += g * s[ i ];
+									coefsB[ i ] += b * s[ i ];
+								}
+							}
+						}
+						proc( count, procCount );
+						count++;
+					}
+				}
+			}
+
+			// Wp[^i[
+			res.set( maxLevel_, &coefs[ 0 ], &coefs[ fnum ], &coefs[ fnum * 2 ], 4.0 / ( (double)width * width ) );
+			return Error();
+		}
+	}
+}
@@ -0,0 +1,161 @@
+#ifndef __ox_oxtexturecontainer_h__
+#define __ox_oxtexturecontainer_h__
+
+// eNX`ReiiDDSAKTXAKTX2j̓ǂݍ݂DDS̏o
+
+#include "oxsphericalharmonics.h"
+#include "oxfileutil.h"
+
+namespace OX {
+	namespace SphericalHarmonics {
+
+		// eNX`Rei
+		//  t@C}bvAzvfAʁA~bṽf[^𕡐ɎQƂ
+		//  L[u}bviL[u}bvz܂ށĵݑΉ
+		class TextureContainer {
+		public:
+			// ubNk̎
+			enum Compression {
+				Compression_None,		// 񈳏k
+				Compression_BC1,		// BC1(DXT1)
+				Compression_BC6H_UF16,	// BC6H
+				Compression_BC6H_SF16,	// BC6Ht
+			};
+
+			// 1ʕ̃f[^
+			struct Surface {
+				const uint8_t *p_ = 0;	// 擪AhXi}bvt@Cj
+				uint32_t width_ = 0;	// eNZ
+				uint32_t height_ = 0;
+				uint64_t pitch_ = 0;	// 1s̃oCgBk1ubNs̃oCg
+				uint64_t size_ = 0;		// ʂ̃oCg
+			};
+
+			TextureContainer() {}
+			~TextureContainer() {}
+
+			// t@CJ
+			//  gqł͂Ȃ擪̎ʎqŌ`𔻒肷
+			Error open( const char *filePath );
+
+			// 
+			//  쐬ς݂CubeDataFromContainer̓}bvLĂ̂ňg
+			void close();
+
+			// ʂ̃eNZ擾
+			uint32_t getTexelSize( uint32_t mip = 0 ) const;
+
+			// ~bv擾
+			uint32_t getMipNum() const;
+
+			// zvfiL[u}bv̐j擾
+			uint32_t getLayerNum() const;
+
+			// sNZtH[}bg擾
+			//  k͓WJ̃tH[}bg
+			const ImageBlock::PixelFormat &getPixelFormat() const;
+
+			// ubNk̎ނ擾
+			Compression getCompression() const;
+
+			// 1ʕ̃f[^擾
+			//  face : CubeData::Face
+			bool getSurface( uint32_t layer, uint32_t mip, uint32_t face, Surface &surface ) const;
+
+			// }bvt@C擾
+			const std::shared_ptr< MappedFile > &getFile() const;
+
+			// L[u}bvDDSŕۑ
+			//  data : ʖɃ~bv0珇ɋl߂f[^iDDS̕сj
+			//  DX10gwb_ŏoB񈳏kDXGI_FORMAT̂tH[}bĝݑΉ
+			static Error saveDDS( const char *filePath, uint32_t width, uint32_t mipNum, const ImageBlock::PixelFormat &format, const uint8_t *data, uint64_t size );
+
+		private:
+			// `̓ǂݍ
+			Error parseDDS();
+			Error parseKTX();
+			Error parseKTX2();
+
+			// ʂ̃oCgƃsb`ݒ
+			//  rowAlign : 񈳏k̍s̃ACg
+			void setSurfaceSize( Surface &surface, uint32_t width, uint32_t height, uint32_t rowAlign ) const;
+
+			// ~bv𐧌Aʂ̍voCgt@CɎ܂ꍇ̂ݖʂ̔zm
+			//  wb_̒lߑȊmۂȂ悤AmۑOɊmF
+			Error allocateSurfaces( uint32_t width, uint32_t rowAlign );
+
+			std::shared_ptr< MappedFile > file_;
+			ImageBlock::PixelFormat format_;
+			Compression compression_ = Compression_None;
+			uint32_t mipNum_ = 0;
+			uint32_t layerNum_ = 0;
+			std::vector< Surface > surfaces_;	// ( layer * mipNum_ + mip ) * 6 + face
+		};
+
+		// eNX`Rei1̃L[u}bvQƂCubeData
+		//  }bvt@C𒼐ڃfR[ĥŁAeNZ𕡐Ȃ
+		//  sRGB̃tH[}bg̓jAlɕϊBubNk̏ꍇ͍s܂ރubNsxWJ
+		class CubeDataFromContainer : public CubeData {
+		public:
+			CubeDataFromContainer() {}
+			virtual ~CubeDataFromContainer() {}
+
+			// 
+			//  layer : zvf
+			//  mip   : ~bvx
+			Error initialize( const TextureContainer &container, uint32_t layer, uint32_t mip );
+
+			// wUVʒuɑ΂l擾
+			virtual RGBA getValue( Face face, int32_t u, int32_t v ) const override;
+
+			// ws̒l𕂓_RGBAŎ擾
+			virtual void getRow( Face face, int32_t v, float *rgba ) const override;
+
+			// }bṽeNZTCY擾
+			virtual uint32_t getTexelSize() const override;
+
+			// sNZtH[}bg擾
+			const ImageBlock::PixelFormat &getPixelFormat() const;
+
+			// ubNk̎ނ擾
+			TextureContainer::Compression getCompression() const;
+
+			// kubN擾
+			//  bx, by : ubNʒuieNZʒu / 4j
+			const uint8_t *getBlock( Face face, int32_t bx, int32_t by ) const;
+
+			// kubNjAȕ_RGBAɓWJ
+			//  rgba : 16 * 4̏o͐
+			void decodeBlock( const uint8_t *block, float *rgba ) const;
+
+		private:
+			// eNZ̕тjAȕ_RGBAɕϊ
+			void decodeRow( const uint8_t *src, uint32_t num, float *rgba ) const;
+
+			std::shared_ptr< MappedFile > file_;	// Qƒ̃}bvێ
+			TextureContainer::Surface surfaces_[ 6 ];
+			ImageBlock::PixelFormat format_;
+			TextureContainer::Compression compression_ = TextureContainer::Compression_None;
+			ImageUtil::RowDecoder decoder_ = 0;
+			ImageUtil::RowDecoderLUT decoderLUT_ = 0;
+			std::shared_ptr< std::vector< float > > decodeTable_;	// sRGB̃fR[he[u
+		};
+
+		// ubNkꂽL[u}bṽp[^
+		//  WJ摜͍炸A4x4eNZ̃ubN̏œWJĎˉe
+		//  l(y_lm * ̊p)CubeEstimaterƓeNZɂ̏ŎZoAe[u͎Ȃ
+		//  BC1̓pbg̃CfbNXɊlvĂ4F|
+		class CompressedCubeEstimater : public Estimater {
+		public:
+			using Estimater::Estimater;
+			virtual ~CompressedCubeEstimater() {}
+
+			// 
+			//  񈳏k̃ReȉꍇCubeEstimaterŐ肷
+			Error estimate( const CubeDataFromContainer *cube, Result &res, const std::function< void( uint64_t count, uint64_t procCount ) > &proc );
+
+		};
+	}
+}
+
+#endif
@@ -1,7 +1,12 @@
 ﻿#include <iostream>
+#include <algorithm>
+#include <cctype>
 #include "cxxopts.hpp"
 #include <stdint.h>
 #include "oxsphericalharmonics.h"
+#include "oxtexturecontainer.h"
+#include "oxreconstructor.h"
+#include "oxprobeset.h"
 #include "oximageutil.h"
 #include "oxfileutil.h"
 
@@ -9,19 +14,49 @@ int main(int argc, char** argv)
 {
 	// オプション
 	int32_t level = 3;
+	int32_t mip = 0;
+	int32_t layer = 0;
+	int32_t cubeMapSize = 128;
+	double autoError = 0.0;
+	double autoEnergy = 0.0;
 	std::string fileBaseName("");
 	std::string ext("");
 	std::string cubeMapFileName("");
+	std::string equirectFileName("");
+	std::string errorMapFileName("");
+	std::string probeSetFileName("");
+	std::string probeEncodingName("f32");
 	std::string outputParamFileName("");
+	std::string maskName("");
+	std::string maskCorrection("renorm");
+	std::string colorSpaceName("linear");
 	bool showProcess = false;
 	bool outputAsText = false;
+	bool hemisphere = false;
+	bool fullDecode = false;
+	bool showMetrics = false;
 	cxxopts::Options options("oxsphericalharmonics.exe", "OX Spheric Harmonics Parameter Estimation (v1.00)");
 	options.add_options()
 		("l,level", "SH band level (def=3)", cxxopts::value< int32_t >(level))
-		("f,file", "Base file name of src image. ('hoge.bmp' -> hoge_l.bmp, hoge_r.bmp and so on.", cxxopts::value< std::string >(fileBaseName))
+		("auto-error", "Choose the smallest level up to -l whose relative RMS error is below this value (option) ('0.05')", cxxopts::value< double >( autoError ) )
+		("auto-energy", "Choose the smallest level up to -l which captures this ratio of the input energy (option) ('0.99')", cxxopts::value< double >( autoEnergy ) )
+		("f,file", "Base file name of src image. ('hoge.bmp' -> hoge_l.bmp, hoge_r.bmp and so on. dds, ktx and ktx2 are read as a cube map container)", cxxopts::value< std::string >(fileBaseName))
+		("mip", "Mip level of cube map container (option, def=0)", cxxopts::value< int32_t >( mip ) )
+		("layer", "Array layer of cube map container (option, def=0)", cxxopts::value< int32_t >( layer ) )
 		("o,output", "Output file name of estimated parameter (hoge.dat)", cxxopts::value< std::string >( outputParamFileName ) )
+		("probe-set", "Output file name of probe set container with the estimated parameter (option) ('probes.oxps')", cxxopts::value< std::string >( probeSetFileName ) )
+		("probe-encoding", "Coefficient encoding of probe set (option) (f64, f32, f16, q8 def=f32)", cxxopts::value< std::string >( probeEncodingName ) )
 		("t,text", "Output estimated parameter as text (option)", cxxopts::value< bool >( outputAsText ) )
-		("c,cubemap", "Output file name of test cube map (option) ('cubemap.bmp')", cxxopts::value< std::string >( cubeMapFileName ) )
+		("c,cubemap", "Output file name of test cube map (option) ('cubemap.bmp'. dds is output with full mip chain)", cxxopts::value< std::string >( cubeMapFileName ) )
+		("cubemap-size", "Face size of test cube map (option, def=128)", cxxopts::value< int32_t >( cubeMapSize ) )
+		("equirect", "Output file name of test lat-long image. The size is (cubemap-size * 4) x (cubemap-size * 2) (option) ('latlong.bmp')", cxxopts::value< std::string >( equirectFileName ) )
+		("m,mask", "Mask of invalid texels (option) ('alpha' or base file name of mask images 'mask.png' -> mask_px.png and so on.)", cxxopts::value< std::string >( maskName ) )
+		("mask-correction", "Correction for masked solid angle (option) (none, renorm, lsq def=renorm)", cxxopts::value< std::string >( maskCorrection ) )
+		("s,colorspace", "Color space of src images. Output cube map is encoded with the same (option) (linear, srgb or gamma value '2.2' def=linear)", cxxopts::value< std::string >( colorSpaceName ) )
+		("hemisphere", "Estimate upper hemisphere (Y+) only with hemispherical harmonics (option)", cxxopts::value< bool >( hemisphere ) )
+		("full-decode", "Decode JPEG faces at full resolution even if the level allows reduced decoding (option)", cxxopts::value< bool >( fullDecode ) )
+		("metrics", "Show error of reconstruction against src images (RMSE, PSNR, max error) (option)", cxxopts::value< bool >( showMetrics ) )
+		("error-map", "Base file name of per face error heatmaps (option) ('error.hdr' -> error_px.hdr and so on.)", cxxopts::value< std::string >( errorMapFileName ) )
 		("p,proc", "Show estimate process (option, def=false)", cxxopts::value< bool >( showProcess ) )
 		("h,help", "Print help")
 		;
@@ -64,44 +99,202 @@ int main(int argc, char** argv)
 		fileNames.push_back( fileBaseName + suffix[ i ] + ext );
 	}
 
+	// 入力の色空間
+	OX::ImageBlock::ColorSpace colorSpace = OX::ImageBlock::ColorSpace_Linear;
+	float gamma = 2.2f;
+	if ( colorSpaceName == "srgb" ) {
+		colorSpace = OX::ImageBlock::ColorSpace_SRGB;
+	} else if ( colorSpaceName != "linear" ) {
+		gamma = (float)atof( colorSpaceName.c_str() );
+		if ( gamma <= 0.0f ) {
+			std::cout << "invalid color space. (-s)" << std::endl;
+			return -1;
+		}
+		colorSpace = OX::ImageBlock::ColorSpace_Gamma;
+	}
+
 	// 指定キューブマップファイルを取り込み
+	//  コンテナの場合は指定のミップ、配列要素を複製せずに参照
+	std::string lowerExt = ext;
+	std::transform( lowerExt.begin(), lowerExt.end(), lowerExt.begin(), []( unsigned char c ) { return (char)std::tolower( c ); } );
+	bool isContainer = ( lowerExt == ".dds" || lowerExt == ".ktx" || lowerExt == ".ktx2" );
 	CubeDataFromImage cubeData;
-	Error err = cubeData.initialize( fileNames );
+	CubeDataFromContainer containerData;
+	const CubeData *cube = &cubeData;
+	Error err;
+	if ( isContainer ) {
+		TextureContainer container;
+		err = container.open( ( fileBaseName + ext ).c_str() );
+		if ( err.error_ == false )
+			err = containerData.initialize( container, layer, mip );
+		cube = &containerData;
+	} else {
+		cubeData.setColorSpace( colorSpace, gamma );
+		if ( fullDecode == false )
+			cubeData.setReducedDecode( level );
+		err = cubeData.initialize( fileNames );
+	}
 	if (err.error_ == true) {
 		// 読み込みエラー
 		std::cout << "failed to create cube data object.\n" << err.reason_ << std::endl;
 		return -1;
 	}
 
+	// マスクを設定
+	if ( isContainer && maskName != "" ) {
+		err = Error( "mask is not supported for cube map container." );
+	} else if ( maskName == "alpha" ) {
+		err = cubeData.setMaskFromAlpha();
+	} else if ( maskName != "" ) {
+		std::vector< std::string > maskFileNames;
+		std::string maskExt = OX::FileUtil::getExtName( maskName, true );
+		std::string maskBaseName = OX::FileUtil::getBaseName( maskName, false );
+		for ( int32_t i = 0; i < 6; ++i ) {
+			maskFileNames.push_back( maskBaseName + suffix[ i ] + maskExt );
+		}
+		err = cubeData.setMaskFromFiles( maskFileNames );
+	}
+	if ( err.error_ == true ) {
+		std::cout << "failed to set mask.\n" << err.reason_ << std::endl;
+		return -1;
+	}
+
 	// パラメータ推定
 	printf( "Estimate SH parameters from %s.\n", fileBaseName.c_str() );
 	printf( " level=%u, output as %s\n", level, outputAsText ? "text" : "binary" );
 	CubeEstimater cubeEst( level );
+	if ( maskCorrection == "none" ) {
+		cubeEst.setMaskCorrection( CubeEstimater::MaskCorrection_None );
+	} else if ( maskCorrection == "lsq" ) {
+		cubeEst.setMaskCorrection( CubeEstimater::MaskCorrection_LeastSquares );
+	}
+	cubeEst.setAutoLevel( autoError, autoEnergy );
+	if ( cubeEst.isAutoLevel() && ( hemisphere || ( isContainer && containerData.getCompression() != TextureContainer::Compression_None ) ) ) {
+		std::cout << "auto level is not supported for hemisphere or compressed cube map." << std::endl;
+		return -1;
+	}
 	Result shRes;
-	err = cubeEst.estimate( &cubeData, shRes, [ showProcess ]( uint64_t count, uint64_t procCount ) {
-		if ( showProcess && count % ( procCount / 40 ) == 0 ) {
+	auto estProc = [ showProcess ]( uint64_t count, uint64_t procCount ) {
+		if ( showProcess && count % std::max< uint64_t >( procCount / 40, 1 ) == 0 ) {
 			printf( "Param  %llu / %llu\n", count, procCount );
 		}
-	} );
+	};
+	if ( hemisphere ) {
+		HemisphereCubeEstimater hemiEst( level );
+		err = hemiEst.estimate( cube, shRes, estProc );
+	} else if ( isContainer && containerData.getCompression() != TextureContainer::Compression_None ) {
+		CompressedCubeEstimater compressedEst( level );
+		err = compressedEst.estimate( &containerData, shRes, estProc );
+	} else {
+		err = cubeEst.estimate( cube, shRes, estProc );
+	}
 	if ( err.error_ ) {
 		std::cout << "estimate error: " << err.reason_ << std::endl;
 		return -1;
 	}
 
+	// 自動選択したレベルとバンド毎の統計
+	if ( cubeEst.isAutoLevel() ) {
+		const auto &stats = shRes.getBandStatistics();
+		for ( size_t l = 0; l < stats.size(); ++l ) {
+			printf( "Band %2u  energy %f, captured %f, residual %f\n", (uint32_t)l, stats[ l ].energy_, stats[ l ].capturedRatio_, stats[ l ].residual_ );
+		}
+		printf( "Selected level=%u\n", shRes.getMaxLevel() );
+	}
+
 	// パラメータ出力
 	printf( "Output parameters.\n" );
 	std::shared_ptr< OutputResult > output( outputAsText ? new OutputResultText : new OutputResult );
 	output->output( shRes, outputParamFileName.c_str() );
 
+	// プローブセット出力
+	if ( probeSetFileName != "" ) {
+		const char *encodingNames[] = { "f64", "f32", "f16", "q8" };
+		uint32_t encoding = 0;
+		while ( encoding < ProbeSet::Encoding_Num && probeEncodingName != encodingNames[ encoding ] )
+			++encoding;
+		if ( encoding == ProbeSet::Encoding_Num ) {
+			std::cout << "invalid probe encoding. (--probe-encoding)" << std::endl;
+			return -1;
+		}
+		ProbeSetWriter writer;
+		err = writer.open( probeSetFileName.c_str(), (ProbeSet::Encoding)encoding );
+		if ( err.error_ == false )
+			err = writer.add( shRes );
+		if ( err.error_ == false )
+			err = writer.close();
+		if ( err.error_ ) {
+			std::cout << "failed to output probe set.\n" << err.reason_ << std::endl;
+			return -1;
+		}
+	}
+
 	// テストキューブマップ出力
 	if ( cubeMapFileName != "" ) {
 		printf( "Output cubemap.\n" );
-		auto imageBlocks = createCubeMapFromParameters( shRes, 128, CubeMapType::Horizontal_Cross, [ showProcess ]( uint64_t count, uint64_t procCount ) {
-			if ( showProcess && count % ( procCount / 40 ) == 0 ) {
+		// hdrの場合は浮動小数点のリニア値で、それ以外は入力の色空間で作成
+		std::string cubeMapExt = OX::FileUtil::getExtName( cubeMapFileName );
+		std::transform( cubeMapExt.begin(), cubeMapExt.end(), cubeMapExt.begin(), []( char c ) { return (char)std::tolower( (unsigned char)c ); } );
+		bool isHdr = ( cubeMapExt == "hdr" );
+		uint32_t width = (uint32_t)std::max< int32_t >( cubeMapSize, 1 );
+		// 進捗はタイル毎にまとめて通知されるので、1/40の区切りを越えたら表示
+		uint64_t nextCount = 0;
+		auto cubeProc = [ showProcess, &nextCount ]( uint64_t count, uint64_t procCount ) {
+			if ( showProcess && count >= nextCount ) {
 				printf( "CubeMap  %llu / %llu\n", count, procCount );
+				const uint64_t step = std::max< uint64_t >( procCount / 40, 1 );
+				nextCount = ( count / step + 1 ) * step;
 			}
-		} );
-		OX::ImageUtil::createFileFromImageBlock( imageBlocks[ 0 ], cubeMapFileName.c_str(), OX::ImageUtil::BMP );
+		};
+		if ( cubeMapExt == "dds" ) {
+			// ddsは半精度浮動小数点のリニアなRGBAで全てのミップを1つのファイルに出力
+			CubeMipChain mipChain;
+			err = mipChain.create( shRes, width, 0, OX::ImageBlock::PixelFormat( 4, OX::ImageBlock::ComponentType_F16 ), cubeProc );
+			if ( err.error_ == false )
+				err = mipChain.saveDDS( cubeMapFileName.c_str() );
+			if ( err.error_ ) {
+				std::cout << "failed to output cube map.\n" << err.reason_ << std::endl;
+				return -1;
+			}
+		} else {
+			auto imageBlocks = createCubeMapFromParameters( shRes, width, CubeMapType::Horizontal_Cross, cubeProc, isHdr ? OX::ImageBlock::ComponentType_F32 : OX::ImageBlock::ComponentType_U8, isHdr ? OX::ImageBlock::ColorSpace_Linear : colorSpace, gamma );
+			OX::ImageUtil::createFileFromImageBlock( imageBlocks[ 0 ], cubeMapFileName.c_str(), OX::ImageUtil::BMP );
+		}
+	}
+
+	// 入力との誤差
+	if ( showMetrics || errorMapFileName != "" ) {
+		Reconstructor reconstructor;
+		reconstructor.setResult( shRes );
+		Reconstructor::ErrorMetrics metrics;
+		std::vector< OX::ImageBlock > heatmaps;
+		if ( reconstructor.measureError( cube, 0.0, metrics, errorMapFileName != "" ? &heatmaps : 0, []( uint64_t, uint64_t ) {} ) == false ) {
+			std::cout << "failed to measure error." << std::endl;
+			return -1;
+		}
+		if ( showMetrics ) {
+			printf( "RMSE  %f (R %f, G %f, B %f)\n", metrics.rmse_, metrics.channelRmse_[ 0 ], metrics.channelRmse_[ 1 ], metrics.channelRmse_[ 2 ] );
+			printf( "PSNR  %f dB (peak %f)\n", metrics.psnr_, metrics.peak_ );
+			printf( "Max error  %f\n", metrics.maxError_ );
+			for ( int32_t i = 0; i < 6; ++i )
+				printf( "RMSE%s  %f\n", suffix[ i ], metrics.faceRmse_[ i ] );
+		}
+		if ( errorMapFileName != "" ) {
+			std::string mapExt = OX::FileUtil::getExtName( errorMapFileName, true );
+			std::string mapBaseName = OX::FileUtil::getBaseName( errorMapFileName, false );
+			std::string mapFileNames[ 6 ];
+			for ( int32_t i = 0; i < 6; ++i )
+				mapFileNames[ i ] = mapBaseName + suffix[ i ] + mapExt;
+			OX::ImageUtil::createFilesFromImageBlocks( heatmaps.data(), mapFileNames, 6 );
+		}
+	}
+
+	// テスト緯度経度画像出力
+	if ( equirectFileName != "" ) {
+		printf( "Output lat-long image.\n" );
+		uint32_t width = (uint32_t)std::max< int32_t >( cubeMapSize, 1 );
+		auto image = createEquirectFromParameters( shRes, width * 4, width * 2, []( uint64_t, uint64_t ) {}, OX::ImageBlock::ComponentType_U8, colorSpace, gamma );
+		OX::ImageUtil::createFileFromImageBlock( image, equirectFileName.c_str(), OX::ImageUtil::BMP );
 	}
 
 	return 0;